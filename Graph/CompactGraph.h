@@ -0,0 +1,451 @@
+/*
+ * CompactGraph.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef COMPACTGRAPH_H_
+#define COMPACTGRAPH_H_
+
+#include "GraphUtil.h"
+#include <memory>
+#include <iterator>
+
+namespace graph {
+
+
+/*** CompactGraph ***/
+
+/* @brief: Read-only weighted adjacency in compressed sparse row form.
+ * The edges going from node u are stored at indices [offset[u], offset[u+1])
+ * of the target and weight arrays, so traversing a node's edges streams
+ * through contiguous memory instead of chasing one allocation per node.
+ * The arrays are either owned, or a read-only view of memory kept alive by some
+ * other object, e.g. a memory mapped file (see GraphFile)
+ * @param: Weight - the type of the edge weights
+ * @param: Node - the type in which the destination nodes are stored, at most as wide as uint
+ * @notes: Built by the freeze() method of the graph classes */
+template<typename Weight, typename Node>
+class BasicCompactGraph {
+public:
+	typedef pair<Node,Weight> EdgePair; // first: destination node  second: edge weight
+	/* Iterator over the edges of a single node. Dereferences to an EdgePair so
+	 * that code written against the vector<EdgeList> adjacency works unchanged,
+	 * standard algorithms included. The EdgePair is made on the fly and returned by value */
+	class const_iterator {
+		const Node* v;
+		const Weight* w;
+		struct arrow {
+			EdgePair e;
+			const EdgePair* operator->() const {return &e;}
+		};
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef EdgePair value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef EdgePair reference;
+		typedef arrow pointer;
+		const_iterator() : v(NULL), w(NULL) {}
+		const_iterator(const Node* v, const Weight* w) : v(v), w(w) {}
+		EdgePair operator*() const {return EdgePair(*v,*w);}
+		arrow operator->() const {return {EdgePair(*v,*w)};}
+		const_iterator& operator++() {++v; ++w; return *this;}
+		const_iterator operator++(int) {const_iterator it = *this; ++*this; return it;}
+		bool operator==(const const_iterator& it) const {return v == it.v;}
+		bool operator!=(const const_iterator& it) const {return v != it.v;}
+	};
+protected:
+	uint N;
+	const uint* offset; /* N+1 entries, offset[N] is the number of edges */
+	const Node* target;
+	const Weight* weight;
+	vector<uint> offsetData; /* storage of the arrays unless they are a view */
+	vector<Node> targetData;
+	vector<Weight> weightData;
+	std::shared_ptr<const void> owner; /* keeps the memory of a view alive */
+public:
+	BasicCompactGraph() : N(0), offsetData(1,0) {bind();}
+	BasicCompactGraph(const BasicCompactGraph& g) {*this = g;}
+	BasicCompactGraph(BasicCompactGraph&& g) : N(0) {*this = std::move(g);}
+	BasicCompactGraph& operator=(const BasicCompactGraph& g);
+	BasicCompactGraph& operator=(BasicCompactGraph&& g);
+	template<typename EdgeList>
+	void assign(const vector<EdgeList>& edges);
+	void assign(vector<uint>& offset, vector<Node>& target, vector<Weight>& weight);
+	template<typename Adj>
+	void assignReverse(uint n, const Adj& g);
+	void view(uint n, const uint* offset, const Node* target, const Weight* weight, std::shared_ptr<const void> owner);
+	template<typename EdgeList>
+	void unpack(vector<EdgeList>& edges) const;
+	void permute(const vector<uint>& order);
+	bool makeLoop(uint u, uint v, Weight w);
+	void clear();
+	uint size() const {return N;}
+	uint numEdges() const {return offset[N];}
+	uint degree(uint u) const {return offset[u+1] - offset[u];}
+	/* @return: Whether the arrays are a view of memory owned by something else */
+	bool isView() const {return owner != nullptr;}
+	/* @return: The arrays, offsets() has size()+1 entries and the others numEdges() */
+	const uint* offsets() const {return offset;}
+	const Node* targets() const {return target;}
+	const Weight* weights() const {return weight;}
+	/* @return: Begin Iterator for edges going from node u */
+	const_iterator begin(uint u) const {return const_iterator(target + offset[u], weight + offset[u]);}
+	/* @return: Beyond-end Iterator for edges going from node u */
+	const_iterator end(uint u) const {return const_iterator(target + offset[u+1], weight + offset[u+1]);}
+private:
+	void bind() {offset = offsetData.data(); target = targetData.data(); weight = weightData.data();}
+};
+
+typedef BasicCompactGraph<int,uint> CompactGraph;
+
+
+
+/* @brief: Packs per-node edge lists into the offset/target/weight arrays
+ * @param: edges - one list of (destination, weight) pairs per node */
+template<typename Weight, typename Node>
+template<typename EdgeList>
+void BasicCompactGraph<Weight,Node>::assign(const vector<EdgeList>& edges) {
+	owner.reset();
+	N = edges.size();
+	auto& offset = offsetData;
+	offset.resize(N+1);
+	offset[0] = 0;
+	for (uint u = 0; u < N; ++u)
+		offset[u+1] = offset[u] + edges[u].size();
+	targetData.resize(offset[N]);
+	weightData.resize(offset[N]);
+	for (uint u = 0; u < N; ++u) {
+		uint i = offset[u];
+		for (auto e = edges[u].begin(); e != edges[u].end(); ++e, ++i) {
+			targetData[i] = e->first;
+			weightData[i] = e->second;
+		}
+	}
+	bind();
+}
+
+/* @brief: Packs the reverse of a graph, i.e. for every edge u->v of g the edge v->u with the same weight
+ * @param: n - number of nodes in g
+ * @param: g - any adjacency with begin(u)/end(u) iterating over (destination, weight) pairs */
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicCompactGraph<Weight,Node>::assignReverse(uint n, const Adj& g) {
+	owner.reset();
+	N = n;
+	auto& offset = offsetData;
+	offset.assign(N+1,0);
+	for (uint u = 0; u < N; ++u)
+		for (auto e = g.begin(u); e != g.end(u); ++e)
+			++offset[e->first+1];
+	for (uint u = 0; u < N; ++u)
+		offset[u+1] += offset[u];
+	targetData.resize(offset[N]);
+	weightData.resize(offset[N]);
+	vector<uint> fill(offset.begin(), offset.end()-1);
+	for (uint u = 0; u < N; ++u)
+		for (auto e = g.begin(u); e != g.end(u); ++e) {
+			uint i = fill[e->first]++;
+			targetData[i] = u;
+			weightData[i] = e->second;
+		}
+	bind();
+}
+
+/* @brief: Makes this a read-only view of arrays owned by something else, releasing the own arrays
+ * @param: n - number of nodes
+ * @param: offset, target, weight - the arrays, laid out as described above
+ * @param: owner - is kept until the view is cleared or reassigned, and must keep the arrays alive */
+template<typename Weight, typename Node>
+void BasicCompactGraph<Weight,Node>::view(uint n, const uint* offset, const Node* target, const Weight* weight, std::shared_ptr<const void> owner) {
+	clear();
+	N = n;
+	this->offset = offset;
+	this->target = target;
+	this->weight = weight;
+	this->owner = owner;
+}
+
+/* @brief: Takes the arrays without copying them, leaving the arguments empty
+ * @param: offset - N+1 offsets where offset[N] = target.size() = weight.size() */
+template<typename Weight, typename Node>
+void BasicCompactGraph<Weight,Node>::assign(vector<uint>& offset, vector<Node>& target, vector<Weight>& weight) {
+	clear();
+	N = offset.size() - 1;
+	offsetData.swap(offset);
+	targetData.swap(target);
+	weightData.swap(weight);
+	bind();
+}
+
+/* Moves the arrays of g, leaving it empty */
+template<typename Weight, typename Node>
+BasicCompactGraph<Weight,Node>& BasicCompactGraph<Weight,Node>::operator=(BasicCompactGraph&& g) {
+	if (this == &g) return *this;
+	N = g.N;
+	owner = std::move(g.owner);
+	offsetData.swap(g.offsetData); //the pointers of g stay valid, owned arrays keep their storage
+	targetData.swap(g.targetData);
+	weightData.swap(g.weightData);
+	offset = g.offset;
+	target = g.target;
+	weight = g.weight;
+	g.clear();
+	return *this;
+}
+
+/* Copies owned arrays, while a view only copies the pointers and shares the owner */
+template<typename Weight, typename Node>
+BasicCompactGraph<Weight,Node>& BasicCompactGraph<Weight,Node>::operator=(const BasicCompactGraph& g) {
+	if (this == &g) return *this;
+	N = g.N;
+	owner = g.owner;
+	offsetData = g.offsetData;
+	targetData = g.targetData;
+	weightData = g.weightData;
+	if (owner) {
+		offset = g.offset;
+		target = g.target;
+		weight = g.weight;
+	}
+	else
+		bind();
+	return *this;
+}
+
+/* @brief: Writes the packed edges back into one list per node, in the order they were added
+ * @param: edges - is resized to hold size() lists */
+template<typename Weight, typename Node>
+template<typename EdgeList>
+void BasicCompactGraph<Weight,Node>::unpack(vector<EdgeList>& edges) const {
+	edges.resize(N);
+	for (uint u = 0; u < N; ++u) {
+		edges[u].clear();
+		edges[u].reserve(degree(u));
+		for (uint i = offset[u]; i < offset[u+1]; ++i)
+			edges[u].push_back({target[i],weight[i]});
+	}
+}
+
+/* @brief: Renumbers every node u to order[u], keeping the order of the edges of each node.
+ * The arrays are rebuilt, so a view becomes owned arrays
+ * @param: order - permutation of [0,size()) */
+template<typename Weight, typename Node>
+void BasicCompactGraph<Weight,Node>::permute(const vector<uint>& order) {
+	vector<uint> original(N), off(N+1);
+	vector<Node> tgt(numEdges());
+	vector<Weight> wgt(numEdges());
+	for (uint u = 0; u < N; ++u)
+		original[order[u]] = u;
+	off[0] = 0;
+	for (uint i = 0; i < N; ++i) {
+		uint u = original[i];
+		off[i+1] = off[i] + degree(u);
+		for (uint j = offset[u], k = off[i]; j < offset[u+1]; ++j, ++k) {
+			tgt[k] = order[target[j]];
+			wgt[k] = weight[j];
+		}
+	}
+	assign(off, tgt, wgt);
+}
+
+/* @brief: Turns one edge from u to v with weight w into the loop u->u with the same weight,
+ * which removes it for shortest path searches with nonnegative weights without repacking.
+ * The arrays must be owned, not a view, which is asserted
+ * @return: false if there is no such edge */
+template<typename Weight, typename Node>
+bool BasicCompactGraph<Weight,Node>::makeLoop(uint u, uint v, Weight w) {
+	assert(!owner);
+	for (uint i = offset[u]; i < offset[u+1]; ++i)
+		if (targetData[i] == v && weightData[i] == w) {
+			targetData[i] = u;
+			return true;
+		}
+	return false;
+}
+
+/* Release all memory held by the packed arrays */
+template<typename Weight, typename Node>
+void BasicCompactGraph<Weight,Node>::clear() {
+	N = 0;
+	owner.reset();
+	vector<uint>(1,0).swap(offsetData);
+	vector<Node>().swap(targetData);
+	vector<Weight>().swap(weightData);
+	bind();
+}
+
+
+/*** CompactAdjacency ***/
+
+/* @brief: Read-only unweighted adjacency in compressed sparse row form, the counterpart
+ * of CompactGraph for GraphD. Iterators are plain pointers into the target array.
+ * Like CompactGraph, the arrays may be a view of memory owned by something else
+ * @notes: Built by GraphD::freeze() */
+class CompactAdjacency {
+public:
+	typedef const uint* const_iterator;
+protected:
+	uint N;
+	const uint* offset; /* N+1 entries, offset[N] is the number of edges */
+	const uint* target;
+	vector<uint> offsetData; /* storage of the arrays unless they are a view */
+	vector<uint> targetData;
+	std::shared_ptr<const void> owner; /* keeps the memory of a view alive */
+public:
+	CompactAdjacency() : N(0), offsetData(1,0) {bind();}
+	CompactAdjacency(const CompactAdjacency& g) {*this = g;}
+	CompactAdjacency(CompactAdjacency&& g) : N(0) {*this = std::move(g);}
+	CompactAdjacency& operator=(const CompactAdjacency& g);
+	CompactAdjacency& operator=(CompactAdjacency&& g);
+	template<typename EdgeList>
+	void assign(const vector<EdgeList>& edges);
+	void assign(vector<uint>& offset, vector<uint>& target);
+	template<typename Adj>
+	void assignReverse(uint n, const Adj& g);
+	void view(uint n, const uint* offset, const uint* target, std::shared_ptr<const void> owner);
+	template<typename EdgeList>
+	void unpack(vector<EdgeList>& edges) const;
+	void permute(const vector<uint>& order);
+	void clear();
+	uint size() const {return N;}
+	uint numEdges() const {return offset[N];}
+	uint degree(uint u) const {return offset[u+1] - offset[u];}
+	/* @return: Whether the arrays are a view of memory owned by something else */
+	bool isView() const {return owner != nullptr;}
+	/* @return: The arrays, offsets() has size()+1 entries and targets() numEdges() */
+	const uint* offsets() const {return offset;}
+	const uint* targets() const {return target;}
+	/* @return: Begin Iterator for edges going from node u */
+	const_iterator begin(uint u) const {return target + offset[u];}
+	/* @return: Beyond-end Iterator for edges going from node u */
+	const_iterator end(uint u) const {return target + offset[u+1];}
+private:
+	void bind() {offset = offsetData.data(); target = targetData.data();}
+};
+
+
+
+/* @brief: Packs per-node lists of destination nodes into the offset/target arrays */
+template<typename EdgeList>
+void CompactAdjacency::assign(const vector<EdgeList>& edges) {
+	owner.reset();
+	N = edges.size();
+	auto& offset = offsetData;
+	offset.resize(N+1);
+	offset[0] = 0;
+	for (uint u = 0; u < N; ++u)
+		offset[u+1] = offset[u] + edges[u].size();
+	targetData.resize(offset[N]);
+	for (uint u = 0; u < N; ++u)
+		std::copy(edges[u].begin(), edges[u].end(), targetData.begin() + offset[u]);
+	bind();
+}
+
+/* @brief: Packs the reverse of a graph, i.e. for every edge u->v of g the edge v->u
+ * @param: n - number of nodes in g
+ * @param: g - any adjacency with begin(u)/end(u) iterating over destination nodes */
+template<typename Adj>
+void CompactAdjacency::assignReverse(uint n, const Adj& g) {
+	owner.reset();
+	N = n;
+	auto& offset = offsetData;
+	offset.assign(N+1,0);
+	for (uint u = 0; u < N; ++u)
+		for (auto e = g.begin(u); e != g.end(u); ++e)
+			++offset[*e+1];
+	for (uint u = 0; u < N; ++u)
+		offset[u+1] += offset[u];
+	targetData.resize(offset[N]);
+	vector<uint> fill(offset.begin(), offset.end()-1);
+	for (uint u = 0; u < N; ++u)
+		for (auto e = g.begin(u); e != g.end(u); ++e)
+			targetData[fill[*e]++] = u;
+	bind();
+}
+
+/* @brief: Makes this a read-only view of arrays owned by something else, like CompactGraph::view */
+void CompactAdjacency::view(uint n, const uint* offset, const uint* target, std::shared_ptr<const void> owner) {
+	clear();
+	N = n;
+	this->offset = offset;
+	this->target = target;
+	this->owner = owner;
+}
+
+/* @brief: Takes the arrays without copying them, leaving the arguments empty
+ * @param: offset - N+1 offsets where offset[N] = target.size() */
+void CompactAdjacency::assign(vector<uint>& offset, vector<uint>& target) {
+	clear();
+	N = offset.size() - 1;
+	offsetData.swap(offset);
+	targetData.swap(target);
+	bind();
+}
+
+/* Moves the arrays of g, leaving it empty */
+CompactAdjacency& CompactAdjacency::operator=(CompactAdjacency&& g) {
+	if (this == &g) return *this;
+	N = g.N;
+	owner = std::move(g.owner);
+	offsetData.swap(g.offsetData); //the pointers of g stay valid, owned arrays keep their storage
+	targetData.swap(g.targetData);
+	offset = g.offset;
+	target = g.target;
+	g.clear();
+	return *this;
+}
+
+/* Copies owned arrays, while a view only copies the pointers and shares the owner */
+CompactAdjacency& CompactAdjacency::operator=(const CompactAdjacency& g) {
+	if (this == &g) return *this;
+	N = g.N;
+	owner = g.owner;
+	offsetData = g.offsetData;
+	targetData = g.targetData;
+	if (owner) {
+		offset = g.offset;
+		target = g.target;
+	}
+	else
+		bind();
+	return *this;
+}
+
+/* @brief: Writes the packed edges back into one list per node, in the order they were added */
+template<typename EdgeList>
+void CompactAdjacency::unpack(vector<EdgeList>& edges) const {
+	edges.resize(N);
+	for (uint u = 0; u < N; ++u)
+		edges[u].assign(begin(u), end(u));
+}
+
+/* @brief: Renumbers every node u to order[u] like CompactGraph::permute */
+void CompactAdjacency::permute(const vector<uint>& order) {
+	vector<uint> original(N), off(N+1), tgt(numEdges());
+	for (uint u = 0; u < N; ++u)
+		original[order[u]] = u;
+	off[0] = 0;
+	for (uint i = 0; i < N; ++i) {
+		uint u = original[i];
+		off[i+1] = off[i] + degree(u);
+		for (uint j = offset[u], k = off[i]; j < offset[u+1]; ++j, ++k)
+			tgt[k] = order[target[j]];
+	}
+	assign(off, tgt);
+}
+
+/* Release all memory held by the packed arrays */
+void CompactAdjacency::clear() {
+	N = 0;
+	owner.reset();
+	vector<uint>(1,0).swap(offsetData);
+	vector<uint>().swap(targetData);
+	bind();
+}
+
+
+} //namespace graph
+
+#endif /* COMPACTGRAPH_H_ */
@@ -0,0 +1,213 @@
+/*
+ * ConnectionScan.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef CONNECTIONSCAN_H_
+#define CONNECTIONSCAN_H_
+
+#include "GraphUtil.h"
+#include "Graph_Time_Table.h"
+#include "PathVector.h"
+
+namespace graph {
+
+
+/*** ConnectionScan ***/
+
+/* @brief: Time table queries with the Connection Scan Algorithm. Every departure of every
+ * edge of a Graph_Time_Table up to a time horizon is listed as a connection, and the
+ * connections are sorted by departure time. A query is then a single pass over a range of
+ * this array, with no priority queue.
+ * @notes: Departures after the horizon are not known, so only journeys that leave every
+ * node at the latest at the horizon are found */
+class ConnectionScan {
+public:
+	/* An earliest arrival at some target for a given departure time */
+	typedef pair<int,int> Journey; // first: departure time  second: arrival time
+protected:
+	struct Connection {
+		int dep, arr;
+		uint u, v;
+		bool operator<(const Connection& c) const {return dep < c.dep || (dep == c.dep && arr < c.arr);}
+	};
+	uint N;
+	int horizon;
+	vector<Connection> conn; /* sorted by departure time, then arrival time */
+public:
+	ConnectionScan() : N(0), horizon(0) {}
+	void build(const Graph_Time_Table& g, int horizon);
+	uint size() const {return N;}
+	size_t numConnections() const {return conn.size();}
+	int getHorizon() const {return horizon;}
+	void getShortestTime(uint s, PathVector& result, int departure = 0) const;
+	int getEarliestArrival(uint s, uint t, int departure = 0) const;
+	template<typename OutIter>
+	OutIter getProfile(uint s, uint t, OutIter out) const;
+protected:
+	size_t first_departure(int t) const;
+	template<typename Improve, typename Stop>
+	static void scan(const Connection* first, const Connection* last, Improve improve, Stop stop);
+};
+
+
+
+/* @brief: Lists every departure of every edge of g from time 0 up to and including horizon
+ * @param: g - the time table
+ * @param: horizon - latest departure time */
+void ConnectionScan::build(const Graph_Time_Table& g, int horizon) {
+	N = g.size();
+	this->horizon = horizon;
+	size_t count = 0;
+	for (uint u = 0; u < N; ++u)
+		for (auto edge = g.begin(u); edge != g.end(u); ++edge)
+			if ((int)edge->t0 <= horizon)
+				count += edge->P == 0 ? 1 : (horizon - edge->t0) / edge->P + 1;
+	conn.clear();
+	conn.reserve(count);
+	for (uint u = 0; u < N; ++u)
+		for (auto edge = g.begin(u); edge != g.end(u); ++edge) {
+			if ((int)edge->t0 > horizon) continue;
+			for (long long t = edge->t0; t <= horizon; t += edge->P) {
+				conn.push_back({(int)t, (int)(t + edge->d), u, edge->v});
+				if (edge->P == 0) break;
+			}
+		}
+	std::sort(conn.begin(), conn.end());
+}
+
+/* @return: Index of the first connection departing at time t or later */
+size_t ConnectionScan::first_departure(int t) const {
+	Connection key = {t, std::numeric_limits<int>::min(), 0, 0};
+	return std::lower_bound(conn.begin(), conn.end(), key) - conn.begin();
+}
+
+/* Calls improve(c) for the connections [first,last) in order, until stop(c) is true.
+ * A connection that takes no time can make one that departs at the same time usable even if
+ * it comes earlier, so when such a connection improves something, the connections departing
+ * at that time are scanned again until nothing changes */
+template<typename Improve, typename Stop>
+void ConnectionScan::scan(const Connection* first, const Connection* last, Improve improve, Stop stop) {
+	const Connection* group = first; /* first connection departing at the current time */
+	bool again = false;
+	for (const Connection* c = first; c != last; ++c) {
+		if (c->dep != group->dep) {
+			while (again) {
+				again = false;
+				for (const Connection* d = group; d != c; ++d)
+					if (improve(*d) && d->arr == d->dep) again = true;
+			}
+			group = c;
+		}
+		if (stop(*c)) return;
+		if (improve(*c) && c->arr == c->dep) again = true;
+	}
+	while (again) {
+		again = false;
+		for (const Connection* d = group; d != last; ++d)
+			if (improve(*d) && d->arr == d->dep) again = true;
+	}
+}
+
+/* @brief: Updates the passed PathVector object to contain the earliest time each node can be
+ * reached when leaving s at the given time, like Graph_Time_Table::getShortestTime does for
+ * departure 0. If no node can be reached, the time is graph::inf.
+ * @param: s - source node
+ * @param: result - Path object to hold the arrival time at each node and the best path
+ * @param: departure - time of leaving s */
+void ConnectionScan::getShortestTime(uint s, PathVector& result, int departure) const {
+	result.u = s;
+	auto& arr = result.dist;
+	auto& prev = result.prev;
+	arr.assign(N,inf);
+	prev.assign(N,-1);
+	arr[s] = departure;
+	const Connection* c = conn.data() + first_departure(departure);
+	const Connection* end = conn.data() + conn.size();
+	auto improve = [&](const Connection& c) {
+		if (arr[c.u] > c.dep || c.arr >= arr[c.v]) return false;
+		arr[c.v] = c.arr;
+		prev[c.v] = c.u;
+		return true;
+	};
+	scan(c, end, improve, [](const Connection&) {return false;});
+}
+
+/* @brief: Finds the earliest time t can be reached when leaving s at the given time
+ * @param: s - source node
+ * @param: t - target node
+ * @param: departure - time of leaving s
+ * @return: The arrival time, or graph::inf if t can not be reached
+ * @notes: The scan stops at the first connection departing after t has been reached */
+int ConnectionScan::getEarliestArrival(uint s, uint t, int departure) const {
+	vector<int> arr(N,inf);
+	arr[s] = departure;
+	const Connection* c = conn.data() + first_departure(departure);
+	const Connection* end = conn.data() + conn.size();
+	auto improve = [&](const Connection& c) {
+		if (arr[c.u] > c.dep || c.arr >= arr[c.v]) return false;
+		arr[c.v] = c.arr;
+		return true;
+	};
+	scan(c, end, improve, [&](const Connection& c) {return c.dep > arr[t];});
+	return arr[t];
+}
+
+/* @brief: Finds the earliest arrival at t for every departure time from s, i.e. every journey
+ * (departure, arrival) such that no other journey leaves later and arrives earlier or at the same time
+ * @param: s - source node
+ * @param: t - target node
+ * @param: out - output iterator to which the Journeys are written by increasing departure time.
+ * Staying at s until a departure is free, so leaving s at time x arrives at the arrival of the
+ * first Journey departing at x or later
+ * @return: Beyond-end iterator of output range
+ * @notes: One pass over all connections from the latest departure to the earliest, keeping a
+ * profile of Journeys to t for every node. Nothing is written if s is t */
+template<typename OutIter>
+OutIter ConnectionScan::getProfile(uint s, uint t, OutIter out) const {
+	//the profile of each node by decreasing departure time, so arrival times decrease too
+	vector<vector<Journey> > profile(N);
+	//earliest arrival at t when at node v at time x
+	auto arrival = [&](uint v, int x) {
+		if (v == t) return x;
+		const vector<Journey>& p = profile[v];
+		//the last Journey departing at x or later
+		auto it = std::upper_bound(p.rbegin(), p.rend(), x,
+				[](int x, const Journey& j) {return x <= j.first;});
+		return it == p.rend() ? inf : it->second;
+	};
+	auto improve = [&](const Connection& c) {
+		int a = arrival(c.v, c.arr);
+		if (a == inf || c.u == t) return false;
+		vector<Journey>& p = profile[c.u];
+		if (!p.empty() && p.back().second <= a) return false;
+		if (!p.empty() && p.back().first == c.dep) p.back().second = a;
+		else p.push_back({c.dep, a});
+		return true;
+	};
+	const Connection* begin = conn.data();
+	const Connection* c = conn.data() + conn.size();
+	while (c != begin) {
+		const Connection* group = c;
+		while (c != begin && (c-1)->dep == (group-1)->dep) --c;
+		//within the group, later arrivals first, so zero time connections see what they lead to
+		bool again = true;
+		while (again) {
+			again = false;
+			for (const Connection* d = group; d != c; --d)
+				if (improve(*(d-1)) && (d-1)->arr == (d-1)->dep && group - c > 1)
+					again = true;
+		}
+	}
+	for (auto it = profile[s].rbegin(); it != profile[s].rend(); ++it) {
+		*out = *it; ++out;
+	}
+	return out;
+}
+
+
+} //namespace graph
+
+#endif /* CONNECTIONSCAN_H_ */
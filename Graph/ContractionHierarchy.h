@@ -0,0 +1,426 @@
+/*
+ * ContractionHierarchy.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef CONTRACTIONHIERARCHY_H_
+#define CONTRACTIONHIERARCHY_H_
+
+#include "GraphUtil.h"
+#include "GraphWDP.h"
+#include "IndexedHeap.h"
+
+namespace graph {
+
+
+/*** ContractionHierarchy ***/
+
+/* @brief: Contraction hierarchy of a GraphWDP for fast point-to-point queries.
+ * Preprocessing contracts the nodes one at a time in order of edge difference, adding
+ * shortcut edges that preserve all shortest distances between the remaining nodes. A query
+ * is then a bidirectional search that only follows edges towards nodes contracted later,
+ * which visits a few hundred nodes even on road graphs with millions of nodes.
+ * @notes: The hierarchy is a snapshot, rebuild it after the graph changes. Queries are
+ * answered by a Query object, one per thread */
+class ContractionHierarchy {
+public:
+	typedef GraphWDP::Traits Traits;
+	struct Arc {
+		uint v; /* other end of the edge */
+		int w;
+		uint mid; /* node the shortcut bypasses, or noMid for an edge of the graph */
+	};
+	static const uint noMid = ~0u;
+	class Query;
+protected:
+	uint N;
+	vector<uint> rank; /* position of each node in the contraction order */
+	vector<uint> upOffset; /* edges u->v with rank[u] < rank[v] are upArcs[upOffset[u]..upOffset[u+1]) */
+	vector<Arc> upArcs;
+	vector<uint> downOffset; /* edges v->u with rank[u] < rank[v] are downArcs[downOffset[u]..downOffset[u+1]), stored at u with target v */
+	vector<Arc> downArcs;
+public:
+	ContractionHierarchy() : N(0) {}
+	ContractionHierarchy(const GraphWDP& g) {build(g);}
+	void build(const GraphWDP& g);
+	uint size() const {return N;}
+	/* @return: Position of node u in the contraction order */
+	uint getRank(uint u) const {return rank[u];}
+	/* @return: Number of edges in the search graph, shortcuts included */
+	uint numArcs() const {return upArcs.size() + downArcs.size();}
+private:
+	class Builder;
+	const Arc* find_up(uint u, uint v) const;
+	const Arc* find_down(uint u, uint v) const;
+	void unpack(uint u, const Arc& a, vector<uint>& path) const;
+};
+
+const uint ContractionHierarchy::noMid;
+
+
+/*** ContractionHierarchy::Query ***/
+
+/* @brief: Answers distance and path queries on a ContractionHierarchy. Holds the search state,
+ * which is reset in time proportional to the number of nodes visited by the previous query */
+class ContractionHierarchy::Query {
+	/* State of one direction of the search */
+	struct Side {
+		vector<int> dist;
+		vector<uint> prevArc; /* index of the arc used to reach each node */
+		vector<uint> prevNode;
+		vector<uint> touched;
+		IndexedHeap<int> q;
+	};
+	const ContractionHierarchy* ch;
+	Side side[2]; /* 0: forward search on upArcs, 1: backward search on downArcs */
+public:
+	Query(const ContractionHierarchy& ch);
+	int getDistance(uint s, uint t);
+	template<typename OutIter>
+	int getShortestPath(uint s, uint t, OutIter out);
+private:
+	int search(uint s, uint t, uint& meet);
+	void scan(uint dir, int best);
+};
+
+
+
+/* @brief: Contracts all nodes of g and builds the upward and downward search graphs
+ * @param: g - the graph, which may be frozen */
+class ContractionHierarchy::Builder {
+	/* edge of the graph being contracted, kept in both endpoints' lists */
+	uint N;
+	vector<vector<Arc> > out, in;
+	vector<bool> contracted;
+	vector<int> deletedNeighbors;
+	//witness search state
+	vector<int> wdist;
+	vector<uint> touched;
+	vector<uint> targetMark; /* equals search for the targets of the current witness search */
+	uint search;
+	IndexedHeap<int> q;
+	/* nodes settled per witness search before giving up, when simulating and when contracting.
+	 * Giving up early only adds unnecessary shortcuts */
+	static const uint simulateLimit = 50;
+	static const uint contractLimit = 500;
+public:
+	template<typename Adj>
+	Builder(uint n, const Adj& g);
+	void run(ContractionHierarchy& ch);
+private:
+	void add_arc(uint u, uint v, int w, uint mid);
+	static void remove_arcs(vector<Arc>& arcs, uint v);
+	void witness_search(uint s, uint skip, int maxDist, uint targets, uint limit);
+	int contract(uint v, bool simulate);
+	int priority(uint v);
+};
+
+template<typename Adj>
+ContractionHierarchy::Builder::Builder(uint n, const Adj& g) :
+		N(n), out(n), in(n), contracted(n,false), deletedNeighbors(n,0), wdist(n,inf), targetMark(n,0), search(0), q(n) {
+	for (uint u = 0; u < N; ++u)
+		for (auto edge = g.begin(u); edge != g.end(u); ++edge)
+			if (edge->first != u) add_arc(u, edge->first, edge->second, noMid);
+}
+
+/* Add the edge u->v, or lower the weight of an existing u->v edge */
+void ContractionHierarchy::Builder::add_arc(uint u, uint v, int w, uint mid) {
+	for (auto& a : out[u]) {
+		if (a.v != v) continue;
+		if (w < a.w) {
+			a.w = w; a.mid = mid;
+			for (auto& b : in[v])
+				if (b.v == u) {b.w = w; b.mid = mid;}
+		}
+		return;
+	}
+	out[u].push_back({v,w,mid});
+	in[v].push_back({u,w,mid});
+}
+
+/* Remove the edges to or from v from a node's list */
+void ContractionHierarchy::Builder::remove_arcs(vector<Arc>& arcs, uint v) {
+	for (uint i = 0; i < arcs.size(); ) {
+		if (arcs[i].v == v) {arcs[i] = arcs.back(); arcs.pop_back();}
+		else ++i;
+	}
+}
+
+/* Dijkstra from s among the uncontracted nodes other than skip, until all marked targets
+ * or every node within maxDist is settled, or limit nodes are settled. Leaves the distances in wdist */
+void ContractionHierarchy::Builder::witness_search(uint s, uint skip, int maxDist, uint targets, uint limit) {
+	for (uint u : touched) wdist[u] = inf;
+	q.clear(touched.begin(), touched.end());
+	touched.clear();
+	wdist[s] = 0;
+	touched.push_back(s);
+	q.push(s,0);
+	uint settled = 0;
+	while (!q.empty() && q.topKey() <= maxDist && settled < limit && targets > 0) {
+		uint u = q.top();
+		q.pop();
+		++settled;
+		if (targetMark[u] == search) --targets;
+		for (const Arc& a : out[u]) {
+			if (a.v == skip || contracted[a.v]) continue;
+			int newDist = Traits::add(wdist[u], a.w);
+			if (newDist < wdist[a.v]) {
+				if (wdist[a.v] == inf) touched.push_back(a.v);
+				wdist[a.v] = newDist;
+				q.update(a.v,newDist);
+			}
+		}
+	}
+}
+
+/* Contract node v, adding a shortcut u->x for every path u->v->x without a shorter witness path
+ * @param: simulate - only count the shortcuts
+ * @return: The number of shortcuts needed */
+int ContractionHierarchy::Builder::contract(uint v, bool simulate) {
+	int shortcuts = 0;
+	for (uint i = 0; i < in[v].size(); ++i) {
+		uint u = in[v][i].v;
+		int w1 = in[v][i].w;
+		if (contracted[u]) continue;
+		int maxOut = -1;
+		uint targets = 0;
+		++search;
+		for (const Arc& a : out[v])
+			if (!contracted[a.v] && a.v != u) {
+				maxOut = max(maxOut,a.w);
+				targetMark[a.v] = search;
+				++targets;
+			}
+		if (maxOut < 0) continue;
+		witness_search(u, v, Traits::add(w1,maxOut), targets, simulate ? simulateLimit : contractLimit);
+		for (uint j = 0; j < out[v].size(); ++j) {
+			uint x = out[v][j].v;
+			int w = Traits::add(w1, out[v][j].w);
+			//a path too long to represent is no path, so it needs no shortcut
+			if (contracted[x] || x == u || w == inf || wdist[x] <= w) continue;
+			++shortcuts;
+			if (!simulate) add_arc(u, x, w, v);
+		}
+	}
+	return shortcuts;
+}
+
+/* Edge difference of v plus the number of contracted neighbors, which spreads
+ * the contraction evenly over the graph. Lower is contracted first */
+int ContractionHierarchy::Builder::priority(uint v) {
+	int degree = 0;
+	for (const Arc& a : in[v]) degree += !contracted[a.v];
+	for (const Arc& a : out[v]) degree += !contracted[a.v];
+	return contract(v,true) - degree + deletedNeighbors[v];
+}
+
+/* Contract the nodes in order of priority and fill in the search graphs of ch.
+ * Contracting a node only changes the edges of its neighbors, so their priorities
+ * are recomputed afterwards */
+void ContractionHierarchy::Builder::run(ContractionHierarchy& ch) {
+	typedef pair<int,uint> p_pair;
+	priority_queue<p_pair,vector<p_pair>,std::greater<p_pair> > pq;
+	vector<int> prio(N);
+	for (uint v = 0; v < N; ++v) {
+		prio[v] = priority(v);
+		pq.push({prio[v],v});
+	}
+	ch.N = N;
+	ch.rank.assign(N,0);
+	vector<vector<Arc> > up(N), down(N);
+	vector<uint> neighbors;
+	uint order = 0;
+	while (!pq.empty()) {
+		uint v = pq.top().second;
+		int p = pq.top().first;
+		pq.pop();
+		if (contracted[v] || p != prio[v]) continue; //outdated entry
+		contract(v,false);
+		neighbors.clear();
+		for (const Arc& a : out[v])
+			if (!contracted[a.v]) {up[v].push_back(a); neighbors.push_back(a.v);}
+		for (const Arc& a : in[v])
+			if (!contracted[a.v]) {down[v].push_back(a); neighbors.push_back(a.v);}
+		contracted[v] = true;
+		vector<Arc>().swap(out[v]);
+		vector<Arc>().swap(in[v]);
+		ch.rank[v] = order++;
+		std::sort(neighbors.begin(), neighbors.end());
+		neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+		for (uint u : neighbors) {
+			remove_arcs(out[u], v);
+			remove_arcs(in[u], v);
+			++deletedNeighbors[u];
+			int np = priority(u);
+			if (np != prio[u]) {prio[u] = np; pq.push({np,u});}
+		}
+	}
+	ch.upOffset.assign(N+1,0);
+	ch.downOffset.assign(N+1,0);
+	for (uint u = 0; u < N; ++u) {
+		ch.upOffset[u+1] = ch.upOffset[u] + up[u].size();
+		ch.downOffset[u+1] = ch.downOffset[u] + down[u].size();
+	}
+	ch.upArcs.clear(); ch.upArcs.reserve(ch.upOffset[N]);
+	ch.downArcs.clear(); ch.downArcs.reserve(ch.downOffset[N]);
+	for (uint u = 0; u < N; ++u) {
+		ch.upArcs.insert(ch.upArcs.end(), up[u].begin(), up[u].end());
+		ch.downArcs.insert(ch.downArcs.end(), down[u].begin(), down[u].end());
+		vector<Arc>().swap(up[u]);
+		vector<Arc>().swap(down[u]);
+	}
+}
+
+/* @brief: Preprocesses g. Takes time roughly proportional to the number of shortcuts
+ * added times the cost of a witness search */
+void ContractionHierarchy::build(const GraphWDP& g) {
+	if (g.isFrozen()) {Builder b(g.size(), g.getCompact()); b.run(*this);}
+	else {Builder b(g.size(), g); b.run(*this);}
+}
+
+/* @return: The search graph edge u->v where rank[u] < rank[v] */
+const ContractionHierarchy::Arc* ContractionHierarchy::find_up(uint u, uint v) const {
+	for (uint i = upOffset[u]; i < upOffset[u+1]; ++i)
+		if (upArcs[i].v == v) return &upArcs[i];
+	return NULL;
+}
+
+/* @return: The search graph edge v->u where rank[u] < rank[v], stored at u */
+const ContractionHierarchy::Arc* ContractionHierarchy::find_down(uint u, uint v) const {
+	for (uint i = downOffset[u]; i < downOffset[u+1]; ++i)
+		if (downArcs[i].v == v) return &downArcs[i];
+	return NULL;
+}
+
+/* Append the nodes of the graph path represented by edge u->a.v to path, excluding u */
+void ContractionHierarchy::unpack(uint u, const Arc& a, vector<uint>& path) const {
+	struct Segment {uint from, to, mid;};
+	stack<Segment> stk;
+	stk.push({u,a.v,a.mid});
+	while (!stk.empty()) {
+		Segment seg = stk.top();
+		stk.pop();
+		if (seg.mid == noMid) {path.push_back(seg.to); continue;}
+		//the shortcut from->to replaced from->mid->to when mid was contracted
+		const Arc* first = find_down(seg.mid, seg.from);
+		const Arc* second = find_up(seg.mid, seg.to);
+		stk.push({seg.mid, seg.to, second->mid});
+		stk.push({seg.from, seg.mid, first->mid});
+	}
+}
+
+
+
+ContractionHierarchy::Query::Query(const ContractionHierarchy& ch) : ch(&ch) {
+	for (uint d = 0; d < 2; ++d) {
+		side[d].dist.assign(ch.N,inf);
+		side[d].prevArc.resize(ch.N);
+		side[d].prevNode.resize(ch.N);
+		side[d].q.reset(ch.N);
+	}
+}
+
+/* Settle the closest node of direction dir and relax its upward edges, unless the node
+ * can be reached on a shorter path through a higher node (stall-on-demand) */
+void ContractionHierarchy::Query::scan(uint dir, int best) {
+	Side& sd = side[dir];
+	const vector<uint>& offset = dir == 0 ? ch->upOffset : ch->downOffset;
+	const vector<Arc>& arcs = dir == 0 ? ch->upArcs : ch->downArcs;
+	//edges into u in the search direction from higher nodes are stored in the other array
+	const vector<uint>& inOffset = dir == 0 ? ch->downOffset : ch->upOffset;
+	const vector<Arc>& inArcs = dir == 0 ? ch->downArcs : ch->upArcs;
+	uint u = sd.q.top();
+	sd.q.pop();
+	for (uint i = inOffset[u]; i < inOffset[u+1]; ++i) {
+		int d = sd.dist[inArcs[i].v];
+		if (d != inf && Traits::add(d, inArcs[i].w) < sd.dist[u]) return;
+	}
+	for (uint i = offset[u]; i < offset[u+1]; ++i) {
+		uint v = arcs[i].v;
+		int newDist = Traits::add(sd.dist[u], arcs[i].w);
+		if (newDist < sd.dist[v] && newDist < best) {
+			if (sd.dist[v] == inf) sd.touched.push_back(v);
+			sd.dist[v] = newDist;
+			sd.prevArc[v] = i;
+			sd.prevNode[v] = u;
+			sd.q.update(v,newDist);
+		}
+	}
+}
+
+/* Runs the upward searches from s and t
+ * @param: meet - set to the highest node of a shortest path, if one exists
+ * @return: The distance from s to t, or graph::inf */
+int ContractionHierarchy::Query::search(uint s, uint t, uint& meet) {
+	for (uint d = 0; d < 2; ++d) {
+		Side& sd = side[d];
+		for (uint u : sd.touched) sd.dist[u] = inf;
+		sd.q.clear(sd.touched.begin(), sd.touched.end());
+		sd.touched.clear();
+		uint r = d == 0 ? s : t;
+		sd.dist[r] = 0;
+		sd.touched.push_back(r);
+		sd.q.push(r,0);
+	}
+	int best = inf;
+	meet = s;
+	if (s == t) return 0;
+	while (true) {
+		//each direction can stop once its closest node is no closer than the best path found
+		bool f = !side[0].q.empty() && side[0].q.topKey() < best;
+		bool b = !side[1].q.empty() && side[1].q.topKey() < best;
+		if (!f && !b) break;
+		uint dir = f && (!b || side[0].q.topKey() <= side[1].q.topKey()) ? 0 : 1;
+		uint u = side[dir].q.top();
+		if (side[1-dir].dist[u] != inf) {
+			int through = Traits::add(side[0].dist[u], side[1].dist[u]);
+			if (through < best) {
+				best = through;
+				meet = u;
+			}
+		}
+		scan(dir,best);
+	}
+	return best;
+}
+
+/* @return: The length of a shortest path from s to t, or graph::inf if there is none */
+int ContractionHierarchy::Query::getDistance(uint s, uint t) {
+	uint meet;
+	return search(s,t,meet);
+}
+
+/* @brief: Finds a shortest path from s to t and writes its nodes to out starting
+ * from t and ending at s (inclusive), or nothing if there is no path.
+ * Shortcuts are unpacked into edges of the original graph.
+ * @return: The length of the path, or graph::inf if there is no path */
+template<typename OutIter>
+int ContractionHierarchy::Query::getShortestPath(uint s, uint t, OutIter out) {
+	uint meet;
+	int d = search(s,t,meet);
+	if (d == inf) return d;
+	//collect the upward edges s->meet, then unpack them and the downward edges meet->t in order
+	vector<uint> fwd;
+	for (uint v = meet; v != s; v = side[0].prevNode[v])
+		fwd.push_back(v);
+	vector<uint> path(1,s);
+	for (auto it = fwd.rbegin(); it != fwd.rend(); ++it)
+		ch->unpack(side[0].prevNode[*it], ch->upArcs[side[0].prevArc[*it]], path);
+	for (uint v = meet; v != t; v = side[1].prevNode[v]) {
+		//downArcs at prevNode[v] with target v is the edge v->prevNode[v]
+		Arc a = ch->downArcs[side[1].prevArc[v]];
+		a.v = side[1].prevNode[v];
+		ch->unpack(v, a, path);
+	}
+	for (auto it = path.rbegin(); it != path.rend(); ++it) {
+		*out = *it; ++out;
+	}
+	return d;
+}
+
+
+} //namespace graph
+
+#endif /* CONTRACTIONHIERARCHY_H_ */
@@ -0,0 +1,183 @@
+/*
+ * DeltaStepping.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef DELTASTEPPING_H_
+#define DELTASTEPPING_H_
+
+#include "GraphUtil.h"
+#include "GraphWDP.h"
+#include "Parallel.h"
+#include <atomic>
+
+namespace graph {
+
+
+/*** DeltaStepping ***/
+
+/* @brief: Multi-threaded single source shortest paths for GraphWDP.
+ * Nodes are kept in buckets of width delta by tentative distance. The nodes of the
+ * smallest nonempty bucket are processed in parallel: first their light edges (weight
+ * <= delta) are relaxed until the bucket stays empty, then the heavy edges of every node
+ * removed from the bucket are relaxed once. Relaxations are atomic compare-and-swap
+ * updates of the distance and predecessor of a node.
+ * @notes: A small delta does less redundant work but has less parallelism per bucket.
+ * With delta 0 the largest edge weight divided by the average degree is used */
+class DeltaStepping {
+	int delta;
+	uint numThreads;
+public:
+	/* @param: delta - bucket width, 0 to choose automatically
+	 * @param: numThreads - 0 to use one thread per hardware thread */
+	DeltaStepping(int delta = 0, uint numThreads = 0) : delta(delta), numThreads(numThreads) {}
+	void setDelta(int d) {delta = d;}
+	void setNumThreads(uint n) {numThreads = n;}
+	void getShortestDistance(const GraphWDP& g, uint s, PathVector& P) const;
+private:
+	typedef unsigned long long Packed; /* distance in the high half, predecessor in the low half */
+	static Packed pack(int d, int p) {return ((Packed)(uint)d << 32) | (uint)p;}
+	static int dist_of(Packed x) {return (int)(x >> 32);}
+	template<typename Adj>
+	void run(const Adj& g, uint n, uint s, PathVector& P) const;
+};
+
+
+
+/* @brief: Updates the passed PathVector object to contain the shortest paths between s and all
+ * other nodes, exactly like GraphWDP::getShortestDistance. If no path exists, the distance is graph::inf.
+ * @param: g - graph, which may be frozen
+ * @param: s - source node
+ * @param: P - Path object to contain the result */
+void DeltaStepping::getShortestDistance(const GraphWDP& g, uint s, PathVector& P) const {
+	if (g.isFrozen()) run(g.getCompact(), g.size(), s, P);
+	else run(g, g.size(), s, P);
+}
+
+template<typename Adj>
+void DeltaStepping::run(const Adj& g, uint n, uint s, PathVector& P) const {
+	//choose bucket width and count the buckets that can be in use at the same time
+	uint maxWeight = 0;
+	unsigned long long numEdges = 0;
+	for (uint u = 0; u < n; ++u)
+		for (auto edge = g.begin(u); edge != g.end(u); ++edge) {
+			maxWeight = max(maxWeight,(uint)edge->second);
+			++numEdges;
+		}
+	uint D = delta > 0 ? delta : max(1ull, maxWeight * (unsigned long long)n / max(1ull,numEdges));
+	uint B = maxWeight/D + 2; /* bins per thread, used circularly */
+	uint T = getNumThreads(numThreads);
+
+	vector<std::atomic<Packed> > state(n);
+	vector<std::atomic<int> > processed(n); /* distance at which the light edges were last relaxed */
+	vector<std::atomic<char> > removed(n); /* whether a node is in some thread's R for this bucket */
+	struct Local {
+		vector<vector<uint> > bins;
+		vector<uint> R; /* nodes removed from the current bucket, whose heavy edges are relaxed last */
+		uint size;
+		uint offset;
+		uint nextBucket;
+	};
+	vector<Local> local(T);
+	vector<uint> frontier;
+	std::atomic<uint> next(0);
+	Barrier barrier(T);
+	const uint none = ~0u;
+	const uint chunk = 64;
+	P.u = s;
+	P.dist.resize(n);
+	P.prev.resize(n);
+
+	runThreads(T, [&](uint t) {
+		Local& my = local[t];
+		my.bins.resize(B);
+		uint lo = (unsigned long long)n*t/T, hi = (unsigned long long)n*(t+1)/T;
+		for (uint i = lo; i < hi; ++i) {
+			state[i].store(pack(inf,-1), std::memory_order_relaxed);
+			processed[i].store(-1, std::memory_order_relaxed);
+			removed[i].store(0, std::memory_order_relaxed);
+		}
+		//relaxes the edge u->v of weight w, d being the distance of u
+		auto relax = [&](uint u, uint v, int d, int w) {
+			int newDist = GraphWDP::Traits::add(d,w);
+			if (newDist == inf) return; //too long to represent, taken as no path
+			Packed x = pack(newDist,u);
+			Packed old = state[v].load(std::memory_order_relaxed);
+			while (newDist < dist_of(old)) {
+				if (state[v].compare_exchange_weak(old,x)) {
+					my.bins[(newDist/D) % B].push_back(v);
+					return;
+				}
+			}
+		};
+		//moves every thread's bin of bucket b into frontier
+		auto gather = [&](uint b) {
+			my.size = my.bins[b % B].size();
+			barrier.wait();
+			if (t == 0) {
+				uint total = 0;
+				for (uint i = 0; i < T; ++i) {local[i].offset = total; total += local[i].size;}
+				frontier.resize(total);
+				next = 0;
+			}
+			barrier.wait();
+			std::copy(my.bins[b % B].begin(), my.bins[b % B].end(), frontier.begin() + my.offset);
+			my.bins[b % B].clear();
+			barrier.wait();
+		};
+		barrier.wait();
+		if (t == 0) {
+			state[s] = pack(0,-1);
+			frontier.assign(1,s);
+		}
+		barrier.wait();
+		uint cur = 0;
+		while (true) {
+			//light edges, repeated while the bucket gets refilled
+			while (!frontier.empty()) {
+				for (uint i = next.fetch_add(chunk); i < frontier.size(); i = next.fetch_add(chunk)) {
+					for (uint j = i; j < min(i+chunk,(uint)frontier.size()); ++j) {
+						uint u = frontier[j];
+						int d = dist_of(state[u].load());
+						if ((uint)d/D != cur || processed[u].exchange(d) == d) continue; //stale or done
+						if (!removed[u].exchange(1)) my.R.push_back(u);
+						for (auto edge = g.begin(u); edge != g.end(u); ++edge)
+							if ((uint)edge->second <= D) relax(u, edge->first, d, edge->second);
+					}
+				}
+				barrier.wait();
+				gather(cur);
+			}
+			//heavy edges, the distances of the removed nodes are final now
+			for (uint u : my.R) {
+				int d = dist_of(state[u].load());
+				for (auto edge = g.begin(u); edge != g.end(u); ++edge)
+					if ((uint)edge->second > D) relax(u, edge->first, d, edge->second);
+				removed[u].store(0, std::memory_order_relaxed);
+			}
+			my.R.clear();
+			//next bucket is the smallest nonempty one over all threads
+			my.nextBucket = none;
+			for (uint b = cur+1; b < cur+B; ++b)
+				if (!my.bins[b % B].empty()) {my.nextBucket = b; break;}
+			barrier.wait();
+			cur = none;
+			for (uint i = 0; i < T; ++i)
+				cur = min(cur,local[i].nextBucket);
+			if (cur == none) break;
+			gather(cur);
+		}
+		for (uint i = lo; i < hi; ++i) {
+			Packed x = state[i].load(std::memory_order_relaxed);
+			P.dist[i] = dist_of(x);
+			P.prev[i] = (int)(uint)x;
+		}
+	});
+}
+
+
+} //namespace graph
+
+#endif /* DELTASTEPPING_H_ */
@@ -0,0 +1,149 @@
+/*
+ * DijkstraSearch.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef DIJKSTRASEARCH_H_
+#define DIJKSTRASEARCH_H_
+
+#include "GraphUtil.h"
+#include "GraphWDP.h"
+#include "SearchWorkspace.h"
+
+namespace graph {
+
+
+/*** DijkstraSearch ***/
+
+/* @brief: A Dijkstra search on a GraphWDP that settles nodes on demand, in order of distance from
+ * the source. Nodes are settled one at a time by next(), or in runs that stop at a target node, at
+ * a radius or at a number of nodes, and every call continues where the previous one stopped, so
+ * asking for the 10 nearest nodes and then for the 20 nearest only settles 10 more.
+ * The search keeps its state in a SearchWorkspace, so starting a new search takes time
+ * proportional to what the previous one reached rather than to the size of the graph
+ * @notes: The graph must not change during a search. DijkstraSearch searches a GraphWDP,
+ * BasicDijkstraSearch<Weight,Node> a BasicGraphWDP<Weight,Node> */
+template<typename Weight = int, typename Node = uint>
+class BasicDijkstraSearch {
+public:
+	typedef BasicGraphWDP<Weight,Node> Graph;
+	typedef typename Graph::Traits Traits;
+	typedef typename Graph::Distance Distance;
+	typedef typename Graph::SearchWorkspace SearchWorkspace;
+	static constexpr Distance inf = Graph::inf;
+private:
+	const Graph* g;
+	SearchWorkspace W;
+	vector<uint> order; /* settled nodes, in the order they were settled */
+public:
+	BasicDijkstraSearch(const Graph& g) : g(&g) {}
+	BasicDijkstraSearch(const Graph& g, uint s) : g(&g) {start(s);}
+	void start(uint s);
+	bool next(uint& v);
+	bool runUntil(uint t);
+	uint runWithin(Distance radius);
+	uint runNearest(uint k);
+	/* @return: Whether every node reachable from the source is settled */
+	bool done() const {return W.q.empty();}
+	/* @return: The distance of the node next() settles, inf if the search is done */
+	Distance nextDistance() const {return W.q.empty() ? inf : W.q.topKey();}
+	/* @return: Whether the shortest distance to v is known */
+	bool settled(uint v) const {return W.reached(v) && W.q.settled(v);}
+	/* @return: The distance to v if it is settled, otherwise the shortest distance found so far
+	 * or inf if v has not been reached */
+	Distance getDistance(uint v) const {return W.getDistance(v);}
+	/* Writes the nodes of the path to v from v to the source, see PathVector::getPath */
+	template<typename OutIter>
+	OutIter getPath(uint v, OutIter out) const {return W.getPath(v,out);}
+	uint getSource() const {return W.getSource();}
+	/* @return: The settled nodes in order of distance, the source first */
+	const vector<uint>& getSettled() const {return order;}
+private:
+	template<typename Adj>
+	void relax(const Adj& adj, uint u);
+};
+
+typedef BasicDijkstraSearch<> DijkstraSearch;
+
+
+template<typename Weight, typename Node>
+constexpr typename BasicDijkstraSearch<Weight,Node>::Distance BasicDijkstraSearch<Weight,Node>::inf;
+
+
+
+/* @brief: Begins a new search from s, forgetting the previous one
+ * @param: s - source node */
+template<typename Weight, typename Node>
+void BasicDijkstraSearch<Weight,Node>::start(uint s) {
+	W.start(g->size(), s);
+	W.set(s,0,-1);
+	W.q.push(s,0);
+	order.clear();
+}
+
+/* @brief: Settles the closest node that is not settled yet
+ * @param: v - receives the settled node, its distance is getDistance(v)
+ * @return: false if the search is done, in which case v is left as it is */
+template<typename Weight, typename Node>
+bool BasicDijkstraSearch<Weight,Node>::next(uint& v) {
+	if (W.q.empty()) return false;
+	v = W.q.top();
+	W.q.pop();
+	order.push_back(v);
+	if (g->isFrozen()) relax(g->getCompact(), v);
+	else relax(*g, v);
+	return true;
+}
+
+/* @brief: Settles nodes until t is settled, which is immediate if it already is
+ * @return: false if t can not be reached from the source */
+template<typename Weight, typename Node>
+bool BasicDijkstraSearch<Weight,Node>::runUntil(uint t) {
+	if (settled(t)) return true;
+	uint v;
+	while (next(v))
+		if (v == t) return true;
+	return false;
+}
+
+/* @brief: Settles every node within distance radius of the source
+ * @return: The number of nodes settled by this call */
+template<typename Weight, typename Node>
+uint BasicDijkstraSearch<Weight,Node>::runWithin(Distance radius) {
+	uint count = 0, v;
+	while (!W.q.empty() && W.q.topKey() <= radius && next(v))
+		++count;
+	return count;
+}
+
+/* @brief: Settles nodes until the k nodes closest to the source, the source included, are
+ * settled, or fewer if fewer are reachable. Ties at the k:th distance are broken arbitrarily
+ * @return: The number of nodes settled by this call */
+template<typename Weight, typename Node>
+uint BasicDijkstraSearch<Weight,Node>::runNearest(uint k) {
+	uint count = 0, v;
+	while (order.size() < k && next(v))
+		++count;
+	return count;
+}
+
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicDijkstraSearch<Weight,Node>::relax(const Adj& adj, uint u) {
+	Distance d = W.distance(u);
+	for (auto edge = adj.begin(u); edge != adj.end(u); ++edge) {
+		uint v = edge->first;
+		Distance newDist = Traits::add(d, edge->second);
+		if (newDist < W.distance(v)) {
+			W.set(v,newDist,u);
+			W.q.update(v,newDist);
+		}
+	}
+}
+
+
+} //namespace graph
+
+#endif /* DIJKSTRASEARCH_H_ */
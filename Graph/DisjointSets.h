@@ -0,0 +1,68 @@
+/*
+ * DisjointSets.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef DISJOINTSETS_H_
+#define DISJOINTSETS_H_
+
+#include "GraphUtil.h"
+
+namespace graph {
+
+
+/*** DisjointSets ***/
+
+/* @brief: Union-find over the elements [0,n) with union by size and path halving,
+ * so any sequence of operations takes nearly linear time */
+class DisjointSets {
+	vector<uint> parent;
+	vector<uint> size;
+public:
+	DisjointSets(uint n = 0) {reset(n);}
+	void reset(uint n);
+	uint find(uint u);
+	/* @return: The representative of u without modifying the sets, safe to call from
+	 * several threads as long as no thread calls find() or join() */
+	uint findConst(uint u) const {while (parent[u] != u) u = parent[u]; return u;}
+	bool join(uint u, uint v);
+	bool same(uint u, uint v) {return find(u) == find(v);}
+};
+
+
+
+/* Make every element a set of its own */
+void DisjointSets::reset(uint n) {
+	parent.resize(n);
+	size.assign(n,1);
+	for (uint u = 0; u < n; ++u)
+		parent[u] = u;
+}
+
+/* @return: The representative of the set containing u */
+uint DisjointSets::find(uint u) {
+	while (parent[u] != u) {
+		parent[u] = parent[parent[u]];
+		u = parent[u];
+	}
+	return u;
+}
+
+/* @brief: Merge the sets containing u and v
+ * @return: false if they already were the same set */
+bool DisjointSets::join(uint u, uint v) {
+	u = find(u);
+	v = find(v);
+	if (u == v) return false;
+	if (size[u] < size[v]) std::swap(u,v);
+	parent[v] = u;
+	size[u] += size[v];
+	return true;
+}
+
+
+} //namespace graph
+
+#endif /* DISJOINTSETS_H_ */
@@ -0,0 +1,246 @@
+/*
+ * EdgeListFile.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef EDGELISTFILE_H_
+#define EDGELISTFILE_H_
+
+#include "GraphUtil.h"
+#include "CompactGraph.h"
+#include "Parallel.h"
+#include "GraphFile.h"
+#include "GraphD.h"
+#include "GraphWD.h"
+#include "GraphWDP.h"
+#include "GraphWU.h"
+#include <cstring>
+#include <cstdint>
+
+namespace graph {
+
+
+/*** EdgeListFile ***/
+
+/* @brief: Reads graphs from text files with one edge per line, "u v" for GraphD and
+ * "u v w" for the weighted graphs, where the fields are separated by spaces or tabs and
+ * further fields on a line are ignored. Empty lines and lines starting with '#' or '%' are skipped.
+ * The file is mapped into memory and split into one chunk per thread at line boundaries.
+ * Each thread parses its chunk, then the edges are distributed by source node to
+ * ranges of nodes, and each range is packed into the arrays of a CompactGraph with a counting
+ * sort, so no edge list is ever grown one edge at a time.
+ * @notes: The graph is left frozen, with the edges of every node in the order of the file.
+ * The number of nodes is one more than the largest node in the file, or n if that is larger.
+ * All functions return false if the file can not be mapped or a line is malformed,
+ * in which case the graph is left unchanged */
+class EdgeListFile {
+public:
+	static bool read(const char* path, GraphD& g, uint n = 0, uint numThreads = 0);
+	static bool read(const char* path, GraphWD& g, uint n = 0, uint numThreads = 0);
+	static bool read(const char* path, GraphWDP& g, uint n = 0, uint numThreads = 0);
+	static bool read(const char* path, GraphWU& g, uint n = 0, uint numThreads = 0);
+protected:
+	struct Edge {
+		uint u, v;
+		int w;
+	};
+	/* Edges parsed by one thread */
+	struct Chunk {
+		vector<Edge> edges;
+		uint maxNode;
+		bool ok;
+	};
+	static bool load(const char* path, bool weighted, bool undirected, uint n, uint numThreads,
+			vector<uint>& offset, vector<uint>& target, vector<int>* weight);
+	static void parse(const char* p, const char* end, bool weighted, Chunk& c);
+	static const char* skip_blanks(const char* p, const char* end) {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+		return p;
+	}
+	static const char* next_line(const char* p, const char* end) {
+		p = (const char*)memchr(p, '\n', end - p);
+		return p ? p+1 : end;
+	}
+	template<typename T>
+	static const char* parse_int(const char* p, const char* end, T& x);
+};
+
+
+
+/* @brief: Reset g to the graph in the edge list file at path, see EdgeListFile
+ * @param: n - smallest number of nodes of the graph
+ * @param: numThreads - 0 to use one thread per hardware thread */
+bool EdgeListFile::read(const char* path, GraphD& g, uint n, uint numThreads) {
+	vector<uint> offset, target;
+	if (!load(path, false, false, n, numThreads, offset, target, 0)) return false;
+	CompactAdjacency csr;
+	csr.assign(offset, target);
+	g.setCompact(std::move(csr));
+	return true;
+}
+
+bool EdgeListFile::read(const char* path, GraphWD& g, uint n, uint numThreads) {
+	vector<uint> offset, target;
+	vector<int> weight;
+	if (!load(path, true, false, n, numThreads, offset, target, &weight)) return false;
+	CompactGraph csr;
+	csr.assign(offset, target, weight);
+	g.setCompact(std::move(csr));
+	return true;
+}
+
+/* The weights are not checked to be nonnegative */
+bool EdgeListFile::read(const char* path, GraphWDP& g, uint n, uint numThreads) {
+	vector<uint> offset, target;
+	vector<int> weight;
+	if (!load(path, true, false, n, numThreads, offset, target, &weight)) return false;
+	CompactGraph csr;
+	csr.assign(offset, target, weight);
+	g.setCompact(std::move(csr));
+	return true;
+}
+
+/* Each line is an undirected edge, which is added in both directions like GraphWU::addEdge */
+bool EdgeListFile::read(const char* path, GraphWU& g, uint n, uint numThreads) {
+	vector<uint> offset, target;
+	vector<int> weight;
+	if (!load(path, true, true, n, numThreads, offset, target, &weight)) return false;
+	CompactGraph csr;
+	csr.assign(offset, target, weight);
+	g.setCompact(std::move(csr));
+	return true;
+}
+
+/* @brief: Parses the file and builds the packed arrays of the graph
+ * @param: weight - null if the graph is unweighted */
+bool EdgeListFile::load(const char* path, bool weighted, bool undirected, uint n, uint numThreads,
+		vector<uint>& offset, vector<uint>& target, vector<int>* weight) {
+	MappedFile file;
+	if (!file.open(path)) return false;
+	const char* text = file.begin();
+	size_t size = file.size();
+	uint T = getNumThreads(numThreads);
+	if (T > size/65536) T = max<size_t>(1, size/65536);
+
+	//split at the first line break after every T:th of the file
+	vector<const char*> bound(T+1);
+	bound[0] = text;
+	bound[T] = text + size;
+	for (uint t = 1; t < T; ++t)
+		bound[t] = max(bound[t-1], next_line(text + size*t/T, text + size));
+	vector<Chunk> chunk(T);
+	runThreads(T, [&](uint t) {parse(bound[t], bound[t+1], weighted, chunk[t]);});
+	file.close();
+	uint maxNode = 0;
+	bool any = false;
+	for (uint t = 0; t < T; ++t) {
+		if (!chunk[t].ok) return false;
+		if (!chunk[t].edges.empty()) {maxNode = max(maxNode, chunk[t].maxNode); any = true;}
+	}
+	uint N = any ? max(n, maxNode+1) : n;
+
+	//distribute the edges of every chunk to R ranges of nodes, keeping their order
+	uint R = min<uint>(4*T, max<uint>(N,1));
+	auto range = [&](uint u) {return (uint)((uint64_t)u*R/N);};
+	vector<vector<vector<Edge> > > part(T, vector<vector<Edge> >(R));
+	runThreads(T, [&](uint t) {
+		vector<size_t> count(R,0);
+		for (const Edge& e : chunk[t].edges) {
+			++count[range(e.u)];
+			if (undirected) ++count[range(e.v)];
+		}
+		for (uint r = 0; r < R; ++r)
+			part[t][r].reserve(count[r]);
+		for (const Edge& e : chunk[t].edges) {
+			part[t][range(e.u)].push_back(e);
+			if (undirected) part[t][range(e.v)].push_back({e.v,e.u,e.w});
+		}
+		vector<Edge>().swap(chunk[t].edges);
+	});
+
+	//the edges of range r start after the edges of all lower ranges
+	vector<size_t> first(R+1,0);
+	for (uint r = 0; r < R; ++r)
+		for (uint t = 0; t < T; ++t)
+			first[r+1] += part[t][r].size();
+	for (uint r = 0; r < R; ++r)
+		first[r+1] += first[r];
+	if (first[R] > std::numeric_limits<uint>::max()) return false;
+	offset.resize(N+1);
+	target.resize(first[R]);
+	if (weight) weight->resize(first[R]);
+
+	//counting sort of every range by source node, the chunks taken in file order
+	runTasks(R, T, [&](uint r, uint) {
+		uint lo = (uint)(((uint64_t)N*r + R-1)/R), hi = (uint)(((uint64_t)N*(r+1) + R-1)/R);
+		vector<uint> fill(hi-lo,0);
+		for (uint t = 0; t < T; ++t)
+			for (const Edge& e : part[t][r])
+				++fill[e.u-lo];
+		uint pos = first[r];
+		for (uint u = lo; u < hi; ++u) {
+			offset[u] = pos;
+			pos += fill[u-lo];
+			fill[u-lo] = offset[u];
+		}
+		for (uint t = 0; t < T; ++t) {
+			for (const Edge& e : part[t][r]) {
+				uint i = fill[e.u-lo]++;
+				target[i] = e.v;
+				if (weight) (*weight)[i] = e.w;
+			}
+			vector<Edge>().swap(part[t][r]);
+		}
+	});
+	offset[N] = first[R];
+	return true;
+}
+
+/* @brief: Parses the lines of [p,end) into c, setting c.ok to false at the first malformed line */
+void EdgeListFile::parse(const char* p, const char* end, bool weighted, Chunk& c) {
+	c.maxNode = 0;
+	c.ok = true;
+	while (p < end) {
+		p = skip_blanks(p, end);
+		if (p == end) break;
+		if (*p == '\n') {++p; continue;}
+		if (*p == '#' || *p == '%') {p = next_line(p, end); continue;}
+		Edge e;
+		e.w = 0;
+		p = parse_int(p, end, e.u);
+		if (p) p = parse_int(skip_blanks(p, end), end, e.v);
+		if (p && weighted) p = parse_int(skip_blanks(p, end), end, e.w);
+		//a field must be followed by a separator
+		if (!p || (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')) {c.ok = false; return;}
+		c.maxNode = max(c.maxNode, max(e.u, e.v));
+		c.edges.push_back(e);
+		p = next_line(p, end);
+	}
+}
+
+/* @brief: Parses a decimal integer at p, with an optional sign if T is signed
+ * @return: Position after the integer, or null if there is none or it does not fit in T */
+template<typename T>
+const char* EdgeListFile::parse_int(const char* p, const char* end, T& x) {
+	bool negative = false;
+	if (std::numeric_limits<T>::is_signed && p < end && (*p == '-' || *p == '+'))
+		negative = *p++ == '-';
+	const char* start = p;
+	uint64_t v = 0;
+	while (p < end && (uint)(*p - '0') < 10 && p - start < 12)
+		v = v*10 + (*p++ - '0');
+	if (p == start || (p < end && (uint)(*p - '0') < 10)) return 0;
+	//node numbers must leave room for the number of nodes
+	uint64_t limit = std::numeric_limits<T>::is_signed ? (uint64_t)std::numeric_limits<T>::max()
+			: (uint64_t)std::numeric_limits<T>::max() - 1;
+	if (v > limit) return 0;
+	x = negative ? -(T)v : (T)v;
+	return p;
+}
+
+
+} //namespace graph
+
+#endif /* EDGELISTFILE_H_ */
@@ -0,0 +1,358 @@
+/*
+ * FlowNetwork.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef FLOWNETWORK_H_
+#define FLOWNETWORK_H_
+
+#include "GraphUtil.h"
+
+namespace graph {
+
+
+/*** FlowNetwork ***/
+
+/* @brief: Directed graph with edge capacities for maximum flow and minimum cut problems.
+ * Before the first flow computation after edges were added, every edge and its reverse
+ * residual edge are packed next to the other edges of their nodes into contiguous arrays,
+ * where each residual edge knows the index of its pair
+ * @notes: Capacities must be nonnegative. Parallel edges and edges in both directions are allowed */
+class FlowNetwork {
+public:
+	/* Algorithm used by getMaxFlow
+	 * DINIC - augments along blocking flows of shortest residual paths
+	 * PUSH_RELABEL - highest-label push-relabel with global relabeling and the gap heuristic,
+	 *                usually the faster one on large networks */
+	enum FlowAlgorithm { DINIC, PUSH_RELABEL };
+protected:
+	struct Edge {
+		uint u, v;
+		int capacity;
+	};
+	uint N;
+	vector<Edge> edges; /* edges in the order they were added */
+	bool packed; /* whether the arrays below hold all edges */
+	vector<uint> offset; /* residual edges of node u are at [offset[u], offset[u+1]) */
+	vector<uint> head; /* node each residual edge goes to */
+	vector<uint> mate; /* index of the paired residual edge going the other way */
+	vector<int> capacity; /* capacity of each residual edge, 0 for the reverse of an edge */
+	vector<int> residual; /* remaining capacity of each residual edge */
+	vector<uint> arc; /* index of the residual edge of each edge in the last maximum flow */
+	vector<bool> sourceSide;
+	long long flow;
+public:
+	FlowNetwork(uint n) : N(n), packed(false), sourceSide(n,false), flow(0) {}
+	void reset(uint n);
+	/* @return: Number of nodes */
+	uint size() const {return N;}
+	/* @return: Number of edges */
+	uint numEdges() const {return edges.size();}
+	uint addEdge(uint u, uint v, int capacity);
+	long long getMaxFlow(uint s, uint t, FlowAlgorithm alg = PUSH_RELABEL);
+	/* @return: Flow through edge e (as numbered by addEdge) in the last maximum flow, 0 if e was
+	 * added after it or there has been none */
+	int getFlow(uint e) const {return e < arc.size() ? capacity[arc[e]] - residual[arc[e]] : 0;}
+	/* @return: Whether v is on the source side of the minimum cut found by the last getMaxFlow */
+	bool isSourceSide(uint v) const {return sourceSide[v];}
+	template<typename OutIter>
+	OutIter getMinCut(OutIter out) const;
+protected:
+	void pack();
+	long long dinic(uint s, uint t);
+	bool dinic_levels(uint s, uint t, vector<uint>& level, vector<uint>& queue) const;
+	long long push_relabel(uint s, uint t);
+	void discharge_all(uint sink, uint excluded, vector<long long>& excess);
+	void find_cut(uint s);
+};
+
+
+
+/* Reset the network to n nodes and no edges */
+void FlowNetwork::reset(uint n) {
+	N = n;
+	edges.clear();
+	arc.clear();
+	packed = false;
+	sourceSide.assign(n,false);
+	flow = 0;
+}
+
+/* @brief: Add an edge from u to v with the given capacity
+ * @return: Number of the edge, edges being numbered from 0 in the order they are added */
+uint FlowNetwork::addEdge(uint u, uint v, int capacity) {
+	edges.push_back({u,v,capacity});
+	packed = false;
+	return edges.size() - 1;
+}
+
+/* @brief: Computes a maximum flow from s to t, after which getFlow gives the flow through
+ * every edge and getMinCut a minimum cut
+ * @param: s - source node
+ * @param: t - sink node, must not be s
+ * @param: alg - algorithm to use
+ * @return: Value of the maximum flow */
+long long FlowNetwork::getMaxFlow(uint s, uint t, FlowAlgorithm alg) {
+	if (!packed) pack();
+	residual = capacity;
+	flow = alg == DINIC ? dinic(s,t) : push_relabel(s,t);
+	find_cut(s);
+	return flow;
+}
+
+/* @brief: Writes the nodes on the source side of the minimum cut found by the last
+ * getMaxFlow, in increasing order. The edges from these nodes to the other nodes are
+ * saturated and their capacities sum to the maximum flow
+ * @return: Beyond-end iterator of output range */
+template<typename OutIter>
+OutIter FlowNetwork::getMinCut(OutIter out) const {
+	for (uint v = 0; v < N; ++v)
+		if (sourceSide[v]) {*out = v; ++out;}
+	return out;
+}
+
+/* Packs the edges and their reverse residual edges into the arrays, in the order they were added */
+void FlowNetwork::pack() {
+	uint M = 2*edges.size();
+	offset.assign(N+1,0);
+	for (const Edge& e : edges) {
+		++offset[e.u+1];
+		++offset[e.v+1];
+	}
+	for (uint u = 0; u < N; ++u)
+		offset[u+1] += offset[u];
+	head.resize(M);
+	mate.resize(M);
+	capacity.resize(M);
+	arc.resize(edges.size());
+	vector<uint> fill(offset.begin(), offset.end()-1);
+	for (uint i = 0; i < edges.size(); ++i) {
+		const Edge& e = edges[i];
+		uint a = fill[e.u]++, b = fill[e.v]++;
+		head[a] = e.v; head[b] = e.u;
+		mate[a] = b; mate[b] = a;
+		capacity[a] = e.capacity; capacity[b] = 0;
+		arc[i] = a;
+	}
+	packed = true;
+}
+
+/* Marks the nodes reachable from s in the residual network */
+void FlowNetwork::find_cut(uint s) {
+	sourceSide.assign(N,false);
+	vector<uint> stack(1,s);
+	sourceSide[s] = true;
+	while (!stack.empty()) {
+		uint u = stack.back(); stack.pop_back();
+		for (uint a = offset[u]; a < offset[u+1]; ++a)
+			if (residual[a] > 0 && !sourceSide[head[a]]) {
+				sourceSide[head[a]] = true;
+				stack.push_back(head[a]);
+			}
+	}
+}
+
+/* Breadth first search from s in the residual network
+ * @return: Whether t was reached */
+bool FlowNetwork::dinic_levels(uint s, uint t, vector<uint>& level, vector<uint>& queue) const {
+	std::fill(level.begin(), level.end(), N);
+	level[s] = 0;
+	queue.clear();
+	queue.push_back(s);
+	for (uint i = 0; i < queue.size(); ++i) {
+		uint u = queue[i];
+		if (level[u] >= level[t]) break; //nodes beyond the level of t are not on shortest paths
+		for (uint a = offset[u]; a < offset[u+1]; ++a)
+			if (residual[a] > 0 && level[head[a]] == N) {
+				level[head[a]] = level[u] + 1;
+				queue.push_back(head[a]);
+			}
+	}
+	return level[t] < N;
+}
+
+/* @brief: Dinic's algorithm. Each phase finds a blocking flow along the shortest residual paths
+ * with a depth first search, kept as an explicit path so that paths may be arbitrarily long.
+ * Each node keeps the residual edge it continues from, and nodes found to be dead ends leave
+ * the level graph */
+long long FlowNetwork::dinic(uint s, uint t) {
+	long long total = 0;
+	vector<uint> level(N), queue, cur(N), path;
+	while (dinic_levels(s, t, level, queue)) {
+		for (uint u = 0; u < N; ++u)
+			cur[u] = offset[u];
+		path.clear();
+		uint u = s;
+		while (true) {
+			if (u == t) {
+				int f = inf;
+				for (uint a : path)
+					f = min(f, residual[a]);
+				for (uint a : path) {
+					residual[a] -= f;
+					residual[mate[a]] += f;
+				}
+				total += f;
+				//continue from the tail of the first saturated edge
+				uint k = 0;
+				while (residual[path[k]] > 0) ++k;
+				path.resize(k);
+				u = k == 0 ? s : head[path[k-1]];
+				continue;
+			}
+			uint& a = cur[u];
+			while (a < offset[u+1] && !(residual[a] > 0 && level[head[a]] == level[u] + 1))
+				++a;
+			if (a < offset[u+1]) {
+				path.push_back(a);
+				u = head[a];
+			}
+			else {
+				if (u == s) break;
+				level[u] = N; //dead end
+				u = head[mate[path.back()]];
+				path.pop_back();
+				++cur[u];
+			}
+		}
+	}
+	return total;
+}
+
+/* @brief: Highest-label push-relabel. The first phase computes a maximum preflow, where excess
+ * that can not reach t is left at the nodes, and the second phase returns that excess to s so
+ * that the preflow becomes a flow */
+long long FlowNetwork::push_relabel(uint s, uint t) {
+	vector<long long> excess(N,0);
+	for (uint a = offset[s]; a < offset[s+1]; ++a)
+		if (head[a] != s && residual[a] > 0) {
+			excess[head[a]] += residual[a];
+			residual[mate[a]] += residual[a];
+			residual[a] = 0;
+		}
+	discharge_all(t, s, excess);
+	discharge_all(s, t, excess);
+	return excess[t];
+}
+
+/* @brief: Pushes the excess of every node except sink and excluded towards sink, always discharging
+ * the node with the highest label. Labels are distances to sink in the residual network, and nodes
+ * whose label reaches N can not reach sink and are left.
+ * Global relabeling recomputes all labels with a breadth first search from sink when the relabels
+ * have done about as much work as that search, and the gap heuristic lifts every node above a label
+ * that no node has any more to N, since they can not reach sink either
+ * @param: excluded - node that neither receives nor sends flow */
+void FlowNetwork::discharge_all(uint sink, uint excluded, vector<long long>& excess) {
+	const uint none = std::numeric_limits<uint>::max();
+	vector<uint> height(N), cur(N), queue;
+	//active nodes of each label in a stack, and all nodes of each label below N in a doubly linked list
+	vector<uint> active(N+1), nextActive(N), first(N+1), next(N), prev(N);
+	uint maxActive = 0, maxHeight = 0;
+	size_t work = 0, limit = 6*(size_t)N + head.size();
+	auto insert = [&](uint v) {
+		uint h = height[v];
+		next[v] = first[h]; prev[v] = none;
+		if (first[h] != none) prev[first[h]] = v;
+		first[h] = v;
+		maxHeight = max(maxHeight, h);
+	};
+	auto erase = [&](uint v) {
+		uint h = height[v];
+		if (prev[v] != none) next[prev[v]] = next[v]; else first[h] = next[v];
+		if (next[v] != none) prev[next[v]] = prev[v];
+	};
+	auto activate = [&](uint v) {
+		nextActive[v] = active[height[v]];
+		active[height[v]] = v;
+		maxActive = max(maxActive, height[v]);
+	};
+	auto global_relabel = [&]() {
+		std::fill(height.begin(), height.end(), N);
+		std::fill(active.begin(), active.end(), none);
+		std::fill(first.begin(), first.end(), none);
+		maxActive = maxHeight = 0;
+		height[sink] = 0;
+		queue.assign(1,sink);
+		for (uint i = 0; i < queue.size(); ++i) {
+			uint u = queue[i];
+			for (uint a = offset[u]; a < offset[u+1]; ++a) {
+				uint v = head[a];
+				if (residual[mate[a]] > 0 && height[v] == N && v != excluded) {
+					height[v] = height[u] + 1;
+					queue.push_back(v);
+				}
+			}
+		}
+		for (uint i = 1; i < queue.size(); ++i) {
+			uint v = queue[i];
+			cur[v] = offset[v];
+			insert(v);
+			if (excess[v] > 0) activate(v);
+		}
+		work = 0;
+	};
+	//lift every node with label above h to N
+	auto gap = [&](uint h) {
+		for (uint g = h+1; g <= maxHeight; ++g) {
+			for (uint v = first[g]; v != none; v = next[v])
+				height[v] = N;
+			first[g] = none;
+		}
+		maxHeight = h > 0 ? h-1 : 0;
+	};
+	auto relabel = [&](uint u) {
+		uint h = N;
+		work += 12 + offset[u+1] - offset[u];
+		for (uint a = offset[u]; a < offset[u+1]; ++a)
+			if (residual[a] > 0 && height[head[a]] + 1 < h) {
+				h = height[head[a]] + 1;
+				cur[u] = a;
+			}
+		height[u] = h;
+	};
+
+	global_relabel();
+	while (true) {
+		while (maxActive > 0 && active[maxActive] == none) --maxActive;
+		uint u = active[maxActive];
+		if (u == none) break;
+		active[maxActive] = nextActive[u];
+		if (height[u] >= N) continue; //lifted by a gap after it became active
+		//discharge u
+		while (excess[u] > 0) {
+			uint& a = cur[u];
+			if (a == offset[u+1]) {
+				uint h = height[u];
+				erase(u);
+				if (first[h] == none) { //u was the last node with label h
+					height[u] = N;
+					gap(h);
+					break;
+				}
+				relabel(u);
+				if (height[u] >= N) break;
+				insert(u);
+				continue;
+			}
+			uint v = head[a];
+			if (residual[a] > 0 && height[u] == height[v] + 1) {
+				long long f = min<long long>(excess[u], residual[a]);
+				residual[a] -= f;
+				residual[mate[a]] += f;
+				excess[u] -= f;
+				if (excess[v] == 0 && v != sink) activate(v);
+				excess[v] += f;
+			}
+			else
+				++a;
+		}
+		if (work > limit) global_relabel();
+	}
+}
+
+
+} //namespace graph
+
+#endif /* FLOWNETWORK_H_ */
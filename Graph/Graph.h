@@ -9,11 +9,26 @@
 #define GRAPH2_H_
 
 #include "GraphUtil.h"
+#include "CompactGraph.h"
+#include "IndexedHeap.h"
+#include "MonotoneQueue.h"
+#include "Parallel.h"
+#include "DisjointSets.h"
+#include "SearchWorkspace.h"
+#include "NodeOrder.h"
 #include "GraphD.h"
 #include "Graph_Time_Table.h"
 #include "GraphWD.h"
 #include "GraphWDP.h"
 #include "GraphWU.h"
+#include "FlowNetwork.h"
+#include "ContractionHierarchy.h"
+#include "DeltaStepping.h"
+#include "DijkstraSearch.h"
+#include "KShortestPaths.h"
+#include "ConnectionScan.h"
+#include "GraphFile.h"
+#include "EdgeListFile.h"
 
 
 #endif /* GRAPH2_H_ */
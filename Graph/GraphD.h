@@ -9,6 +9,11 @@
 #define GRAPHD_H_
 
 #include "GraphUtil.h"
+#include "CompactGraph.h"
+#include "PathVector.h"
+#include "NodeOrder.h"
+#include "Parallel.h"
+#include <atomic>
 
 namespace graph{
 
@@ -16,89 +21,409 @@ namespace graph{
 
 /*** GraphD ***/
 
-/* @brief: Undirected Nonweighted Graph */
+/* @brief: Directed Nonweighted Graph */
 class GraphD {
 public:
 	typedef vector<uint> EdgeList;
+	/* Outcome of an Eulerian walk search */
+	struct WalkInfo {
+		size_t used; /* number of edges in the walk that was written */
+		size_t total; /* number of edges in the graph */
+		/* @return: Whether the walk uses every edge, i.e. is an Eulerian walk */
+		bool valid() const {return used == total;}
+	};
 protected:
 	uint N;
 	vector<EdgeList> edges;
+	CompactAdjacency csr; /* holds the edges instead of 'edges' while frozen */
+	bool frozen;
+	CompactAdjacency rev; /* reverse edges for bottom-up BFS steps, built on demand */
+	bool reverseValid;
 public:
-	GraphD (uint n) : N(n), edges(n) {}
+	GraphD (uint n) : N(n), edges(n), frozen(false), reverseValid(false) {}
 	void reset(uint n);
-	/* Add edge from u to v */
-	void addEdge(uint u, uint v) {edges[u].push_back(v);}
-	/* @return: Begin Iterator for edges going from node u */
+	/* @return: Number of nodes */
+	uint size() const {return N;}
+	/* Add edge from u to v. The graph must not be frozen */
+	void addEdge(uint u, uint v) {edges[u].push_back(v); reverseValid = false;}
+	/* @return: Begin Iterator for edges going from node u. Use getCompact() while frozen */
 	EdgeList::const_iterator begin(uint u) const {return edges[u].begin();}
-	/* @return: Beyond-end Iterator for edges going from node u */
+	/* @return: Beyond-end Iterator for edges going from node u. Use getCompact() while frozen */
 	EdgeList::const_iterator end(uint u) const {return edges[u].end();}
+	void freeze();
+	void thaw();
+	void permute(const NodeOrder& P);
+	bool isFrozen() const {return frozen;}
+	/* @return: The packed edges, only valid while frozen */
+	const CompactAdjacency& getCompact() const {return csr;}
+	void setCompact(CompactAdjacency g);
 	template<typename OutIter>
-	OutIter getEulerianWalk(OutIter out);
-private:
+	OutIter getEulerianWalk(OutIter out, WalkInfo* info = 0) const;
 	template<typename OutIter>
-	void find_path(uint u, uint* stk_heads, OutIter& out) const;
+	OutIter getEulerianWalkUndirected(OutIter out, WalkInfo* info = 0) const;
+	void getShortestDistance(uint s, PathVector& P, uint numThreads = 0);
+private:
+	void update_reverse();
+	template<typename Adj>
+	void bfs(const Adj& g, uint s, PathVector& P, uint numThreads) const;
+	template<typename Adj, typename OutIter>
+	OutIter hierholzer(const Adj& g, OutIter out, WalkInfo* info) const;
+	template<typename Adj, typename OutIter>
+	OutIter hierholzer_undirected(const Adj& g, OutIter out, WalkInfo* info) const;
 };
 
 
 /* Reset a Graph to another size to save unnecessary reallocation ;) */
 void GraphD::reset(uint n){
+	if (frozen) {csr.clear(); frozen = false;}
+	reverseValid = false;
 	N = n;
 	edges.resize(n);
 	for (uint i = 0; i < n; ++i)
 		edges[i].clear();
 }
 
-/* private utility function for recursion in the Heirholzer alg. */
-template<typename OutIter>
-void GraphD::find_path(uint u, uint* stk_heads, OutIter& out) const {
-	//Heirholzer's algorithm
-	while(stk_heads[u] > 0){
-		--stk_heads[u];
-		uint v = edges[u][stk_heads[u]];
-		this->find_path(v, stk_heads, out);
+/* @brief: Packs all edges into contiguous arrays (see CompactAdjacency) and releases the
+ * per-node edge lists. Call thaw() before adding more edges */
+void GraphD::freeze() {
+	if (frozen) return;
+	csr.assign(edges);
+	vector<EdgeList>().swap(edges);
+	frozen = true;
+}
+
+/* @brief: Replaces the graph by the packed edges g, leaving it frozen with g.size() nodes.
+ * If g is a view, e.g. of a mapped file (see GraphFile), the edges are not copied
+ * and the graph only reads from the memory of the view */
+void GraphD::setCompact(CompactAdjacency g) {
+	vector<EdgeList>().swap(edges);
+	N = g.size();
+	csr = std::move(g);
+	frozen = true;
+	reverseValid = false;
+}
+
+/* @brief: Renumbers every node v to P.newId(v), keeping the order of the edges of each node.
+ * A frozen graph stays frozen, with its packed edges rebuilt
+ * @param: P - an order of the nodes of this graph, see NodeOrder */
+void GraphD::permute(const NodeOrder& P) {
+	reverseValid = false;
+	if (frozen) {csr.permute(P.getPermutation()); return;}
+	vector<EdgeList> e(N);
+	for (uint u = 0; u < N; ++u) {
+		EdgeList& l = e[P.newId(u)];
+		l.swap(edges[u]);
+		for (auto& x : l)
+			x = P.newId(x);
 	}
-	*out = u; ++out;
-	return;
+	edges.swap(e);
+}
+
+/* @brief: Moves the packed edges back into per-node edge lists so that edges can be added again */
+void GraphD::thaw() {
+	if (!frozen) return;
+	csr.unpack(edges);
+	csr.clear();
+	frozen = false;
 }
 
 /* @output: If there is an Eulerian walk, output is path from END to START,
  * if there does not exist one, output is a partial walk. It is up to the caller
  * to confirm the number of edges traversed.
  * @param: out - output iterator to which the result is written
+ * @param: info - if not null, receives the number of edges walked and the total number of edges
  * @return: Beyond-end iterator to output range
- * Implemented using Hierholzer's algorithm */
+ * Implemented using Hierholzer's algorithm with an explicit stack, so the walk
+ * may have any number of edges */
 template<typename OutIter>
-OutIter GraphD::getEulerianWalk(OutIter out){
+OutIter GraphD::getEulerianWalk(OutIter out, WalkInfo* info) const {
+	if (frozen) return hierholzer(csr, out, info);
+	return hierholzer(*this, out, info);
+}
+
+/* @brief: Like getEulerianWalk, but every edge is treated as undirected, i.e. it may
+ * be walked in either direction, and each edge is walked once
+ * @param: out - output iterator to which the result is written
+ * @param: info - if not null, receives the number of edges walked and the total number of edges
+ * @return: Beyond-end iterator to output range */
+template<typename OutIter>
+OutIter GraphD::getEulerianWalkUndirected(OutIter out, WalkInfo* info) const {
+	if (frozen) return hierholzer_undirected(csr, out, info);
+	return hierholzer_undirected(*this, out, info);
+}
+
+template<typename Adj, typename OutIter>
+OutIter GraphD::hierholzer(const Adj& g, OutIter out, WalkInfo* info) const {
+	WalkInfo dummy;
+	if (!info) info = &dummy;
+	info->used = info->total = 0;
 	vector<uint> numIn(N,0); /* check for number of edges going out */
 	vector<uint> stk_heads(N); /* an array of "head indexes" to keep track of used edges without copying the entire edge list */
-	for (int i = 0; i < N; ++i)
-		stk_heads[i] = edges[i].size();
+	for (uint u = 0; u < N; ++u) {
+		stk_heads[u] = g.end(u) - g.begin(u);
+		info->total += stk_heads[u];
+	}
 	int start = -1;
 	int end = -1;
 	//count edges going in
 	for (uint u = 0; u < N; ++u)
-		for (auto it = this->begin(u); it != this->end(u); ++it)
+		for (auto it = g.begin(u); it != g.end(u); ++it)
 			++numIn[*it];
 	for (uint u = 0; u < N; ++u){
 		//too many or too few edges out
-		if (edges[u].size() > numIn[u]) {
+		if (stk_heads[u] == numIn[u] + 1) {
 			if (start != -1) return out;
 			start = u;
 		}
-		else if (edges[u].size() < numIn[u]){
+		else if (stk_heads[u] + 1 == numIn[u]){
 			if (end != -1) return out;
 			end = u;
 		}
-		else if (edges[u].size() != numIn[u])
+		else if (stk_heads[u] != numIn[u])
 			return out;
 	}
 	if( !(start==-1 && end==-1) && (start == -1 || end == -1) ) return out;
-	if (start == -1) start = 0;
-	//even and uneven edges fine, do algorithm
-	this->find_path(start,stk_heads.data(),out);
+	if (start == -1) { //any node with edges
+		start = 0;
+		while (start < (int)N && stk_heads[start] == 0) ++start;
+		if (start == (int)N) start = 0;
+	}
+	vector<uint>().swap(numIn);
+	//Hierholzer's algorithm, a node is written once all of its edges are used
+	vector<uint> stack(1,start);
+	while (!stack.empty()) {
+		uint u = stack.back();
+		if (stk_heads[u] > 0) {
+			--stk_heads[u];
+			stack.push_back(*(g.begin(u) + stk_heads[u]));
+			++info->used;
+		}
+		else {
+			*out = u; ++out;
+			stack.pop_back();
+		}
+	}
+	return out;
+}
+
+template<typename Adj, typename OutIter>
+OutIter GraphD::hierholzer_undirected(const Adj& g, OutIter out, WalkInfo* info) const {
+	WalkInfo dummy;
+	if (!info) info = &dummy;
+	info->used = 0;
+	//incidence lists holding (other end, edge id) for both ends of every edge
+	vector<uint> offset(N+1,0);
+	for (uint u = 0; u < N; ++u)
+		for (auto it = g.begin(u); it != g.end(u); ++it) {
+			++offset[u+1];
+			++offset[*it+1];
+		}
+	for (uint u = 0; u < N; ++u)
+		offset[u+1] += offset[u];
+	info->total = offset[N]/2;
+	int start = -1;
+	uint numOdd = 0;
+	for (uint u = 0; u < N; ++u)
+		if ((offset[u+1] - offset[u]) % 2 == 1) {
+			if (++numOdd > 2) return out;
+			if (start == -1) start = u;
+		}
+	if (start == -1) { //any node with edges
+		start = 0;
+		while (start < (int)N && offset[start+1] == offset[start]) ++start;
+		if (start == (int)N) start = 0;
+	}
+	vector<pair<uint,uint> > incident(offset[N]);
+	vector<uint> stk_heads(offset.begin(), offset.end()-1);
+	uint id = 0;
+	for (uint u = 0; u < N; ++u)
+		for (auto it = g.begin(u); it != g.end(u); ++it, ++id) {
+			incident[stk_heads[u]++] = {*it,id};
+			incident[stk_heads[*it]++] = {u,id};
+		}
+	vector<char> used(id,0);
+	//Hierholzer's algorithm, skipping edges already walked from the other end
+	vector<uint> stack(1,start);
+	while (!stack.empty()) {
+		uint u = stack.back();
+		while (stk_heads[u] > offset[u] && used[incident[stk_heads[u]-1].second])
+			--stk_heads[u];
+		if (stk_heads[u] > offset[u]) {
+			const pair<uint,uint>& e = incident[--stk_heads[u]];
+			used[e.second] = 1;
+			stack.push_back(e.first);
+			++info->used;
+		}
+		else {
+			*out = u; ++out;
+			stack.pop_back();
+		}
+	}
 	return out;
 }
 
+/* Rebuild the reverse edges if edges have been added since they were last built */
+void GraphD::update_reverse() {
+	if (reverseValid) return;
+	if (frozen) rev.assignReverse(N, csr);
+	else rev.assignReverse(N, *this);
+	reverseValid = true;
+}
+
+/* @brief: Updates the passed PathVector object to contain the paths with the fewest edges
+ * between s and all other nodes. If no path exists, the distance is graph::inf
+ * @param: s - source node
+ * @param: P - Path object to contain the result
+ * @param: numThreads - number of threads to use, 0 for one per hardware thread
+ * @notes: Implemented using direction-optimizing breadth first search. While the frontier
+ * is small, its edges are scanned top-down. When they outnumber a fraction of the edges of the
+ * unvisited nodes, each unvisited node instead looks for a parent in a bitmap of the frontier
+ * along its incoming edges, stopping at the first one found. The reverse edges for this are
+ * built on the first call after edges have been added */
+void GraphD::getShortestDistance(uint s, PathVector& P, uint numThreads) {
+	update_reverse();
+	if (frozen) bfs(csr, s, P, numThreads);
+	else bfs(*this, s, P, numThreads);
+}
+
+template<typename Adj>
+void GraphD::bfs(const Adj& g, uint s, PathVector& P, uint numThreads) const {
+	typedef unsigned long long Word;
+	const uint alpha = 15; /* go bottom-up when the frontier has more than 1/alpha of the unexplored edges */
+	const uint beta = 18; /* go top-down again when the frontier has less than 1/beta of the nodes */
+	const uint chunk = 64; /* nodes, or bitmap words, taken by a thread at a time */
+	uint W = (N+63)/64;
+	uint T = getNumThreads(numThreads);
+	vector<std::atomic<Word> > visited(W);
+	vector<Word> front, next; /* frontier bitmaps for bottom-up steps */
+	vector<uint> queue(1,s); /* frontier for top-down steps */
+	struct Local {
+		vector<uint> next; /* nodes found in a top-down step */
+		size_t numNodes;
+		size_t numEdges; /* out edges of the nodes found */
+		size_t offset;
+	};
+	vector<Local> local(T);
+	std::atomic<uint> work(0);
+	Barrier barrier(T);
+	size_t unexplored = 0; /* edges going from unvisited nodes */
+	for (uint u = 0; u < N; ++u)
+		unexplored += g.end(u) - g.begin(u);
+	unexplored -= g.end(s) - g.begin(s);
+	size_t frontNodes = 1;
+	bool bottomUp = false, gather = false, done = false;
+	int level = 0;
+	P.u = s;
+	P.dist.resize(N);
+	P.prev.resize(N);
+
+	runThreads(T, [&](uint t) {
+		Local& my = local[t];
+		uint lo = (unsigned long long)W*t/T, hi = (unsigned long long)W*(t+1)/T;
+		for (uint w = lo; w < hi; ++w)
+			visited[w].store(0, std::memory_order_relaxed);
+		for (uint v = lo*64; v < min(hi*64,N); ++v) {
+			P.dist[v] = inf;
+			P.prev[v] = -1;
+		}
+		barrier.wait();
+		if (t == 0) {
+			P.dist[s] = 0;
+			visited[s/64] |= Word(1) << (s%64);
+		}
+		barrier.wait();
+		while (true) {
+			my.numNodes = my.numEdges = 0;
+			if (!bottomUp) {
+				for (uint i = work.fetch_add(chunk); i < queue.size(); i = work.fetch_add(chunk))
+					for (uint j = i; j < min(i+chunk,(uint)queue.size()); ++j) {
+						uint u = queue[j];
+						for (auto e = g.begin(u); e != g.end(u); ++e) {
+							uint v = *e;
+							Word bit = Word(1) << (v%64);
+							if (visited[v/64].load(std::memory_order_relaxed) & bit) continue;
+							if (visited[v/64].fetch_or(bit) & bit) continue; //another thread got it first
+							P.dist[v] = level+1;
+							P.prev[v] = u;
+							my.next.push_back(v);
+							my.numEdges += g.end(v) - g.begin(v);
+						}
+					}
+				my.numNodes = my.next.size();
+			}
+			else {
+				//each thread owns whole words of the bitmaps, so next needs no atomics
+				for (uint i = work.fetch_add(chunk); i < W; i = work.fetch_add(chunk))
+					for (uint w = i; w < min(i+chunk,W); ++w) {
+						Word found = 0;
+						Word left = ~visited[w].load(std::memory_order_relaxed);
+						if (w == W-1 && N%64) left &= (Word(1) << (N%64)) - 1;
+						for (; left; left &= left-1) {
+							uint v = w*64 + __builtin_ctzll(left);
+							for (auto e = rev.begin(v); e != rev.end(v); ++e)
+								if (front[*e/64] >> (*e%64) & 1) {
+									P.dist[v] = level+1;
+									P.prev[v] = *e;
+									found |= left & -left;
+									++my.numNodes;
+									my.numEdges += g.end(v) - g.begin(v);
+									break;
+								}
+						}
+						next[w] = found;
+						if (found) visited[w].fetch_or(found, std::memory_order_relaxed);
+					}
+			}
+			barrier.wait();
+			if (t == 0) {
+				size_t numNodes = 0, numEdges = 0;
+				for (uint i = 0; i < T; ++i) {
+					local[i].offset = numNodes;
+					numNodes += local[i].numNodes;
+					numEdges += local[i].numEdges;
+				}
+				unexplored -= numEdges;
+				bool nextBottomUp = bottomUp ? numNodes >= N/beta || numNodes > frontNodes : numEdges > unexplored/alpha;
+				gather = false;
+				if (numNodes == 0)
+					done = true;
+				else if (!bottomUp && !nextBottomUp) {
+					queue.resize(numNodes);
+					gather = true;
+				}
+				else if (!bottomUp) { //to bitmap
+					front.assign(W,0);
+					next.resize(W);
+					for (uint i = 0; i < T; ++i) {
+						for (uint v : local[i].next)
+							front[v/64] |= Word(1) << (v%64);
+						local[i].next.clear();
+					}
+				}
+				else if (nextBottomUp)
+					front.swap(next);
+				else { //to queue
+					queue.clear();
+					for (uint w = 0; w < W; ++w)
+						for (Word x = next[w]; x; x &= x-1)
+							queue.push_back(w*64 + __builtin_ctzll(x));
+				}
+				frontNodes = numNodes;
+				bottomUp = nextBottomUp;
+				++level;
+				work = 0;
+			}
+			barrier.wait();
+			if (done) break;
+			if (gather) {
+				std::copy(my.next.begin(), my.next.end(), queue.begin() + my.offset);
+				my.next.clear();
+				barrier.wait();
+			}
+		}
+	});
+}
+
 
 
 } //namespace graph
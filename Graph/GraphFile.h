@@ -0,0 +1,363 @@
+/*
+ * GraphFile.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef GRAPHFILE_H_
+#define GRAPHFILE_H_
+
+#include "GraphUtil.h"
+#include "CompactGraph.h"
+#include "GraphD.h"
+#include "GraphWD.h"
+#include "GraphWDP.h"
+#include "GraphWU.h"
+#include "Graph_Time_Table.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace graph {
+
+
+/*** MappedFile ***/
+
+/* @brief: A whole file mapped read-only into memory, unmapped when the object is destroyed
+ * @notes: Uses the POSIX mmap interface */
+class MappedFile {
+	void* data;
+	size_t length;
+public:
+	MappedFile() : data(0), length(0) {}
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile() {close();}
+	bool open(const char* path);
+	void close();
+	/* @return: First byte of the file, null if no file is mapped or the file is empty */
+	const char* begin() const {return static_cast<const char*>(data);}
+	/* @return: Size of the file in bytes */
+	size_t size() const {return length;}
+};
+
+
+
+/* @brief: Map the file at path, replacing any file mapped before
+ * @return: false if the file could not be opened or mapped */
+bool MappedFile::open(const char* path) {
+	close();
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	bool ok = fstat(fd, &st) == 0;
+	if (ok && st.st_size > 0) {
+		void* p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		ok = p != MAP_FAILED;
+		if (ok) {
+			data = p;
+			length = st.st_size;
+		}
+	}
+	::close(fd); //the mapping stays valid without the descriptor
+	return ok;
+}
+
+/* Unmap the file, if any */
+void MappedFile::close() {
+	if (data) munmap(data, length);
+	data = 0;
+	length = 0;
+}
+
+
+
+/*** GraphFile ***/
+
+/* @brief: Reads and writes graphs in a binary file holding the packed arrays of CompactGraph
+ * and CompactAdjacency, so that loading a graph does not parse or rebuild anything.
+ * map() makes a frozen graph whose edges are a read-only view of the mapped file; the pages are
+ * read from disk as the queries touch them, and the file stays mapped as long as some graph
+ * or copy of its CompactGraph uses it.
+ * Layout of a file, all fields little or big endian as the machine that wrote it:
+ *   header    88 bytes: magic "GRAPHBIN", version, kind, byte order mark 0x01020304, reserved (uint32),
+ *             number of nodes N, number of edges E and the byte offset of each section (uint64),
+ *             where 0 means the section is absent
+ *   sections  each starts at a multiple of 64 bytes, in the order
+ *             offset (N+1 uint32), target (E uint32), weight (E int32),
+ *             t0, P and d of the time table edges (E uint32 each)
+ * @notes: All functions return false on failure, e.g. if the file can not be opened, is not a graph
+ * file, was written on a machine of the other byte order or holds another kind of graph.
+ * The sizes of the sections are checked when mapping, but the contents are only checked if asked to */
+class GraphFile {
+public:
+	/* Kind of graph in a file */
+	enum Kind { UNWEIGHTED, WEIGHTED_DIRECTED, WEIGHTED_UNDIRECTED, TIME_TABLE };
+	static const uint32_t version = 1;
+	static bool write(const char* path, const GraphD& g);
+	static bool write(const char* path, const GraphWD& g);
+	static bool write(const char* path, const GraphWU& g);
+	static bool write(const char* path, const Graph_Time_Table& g);
+	static bool map(const char* path, GraphD& g, bool check = false);
+	static bool map(const char* path, GraphWD& g, bool check = false);
+	static bool map(const char* path, GraphWDP& g, bool check = false);
+	static bool map(const char* path, GraphWU& g, bool check = false);
+	static bool read(const char* path, Graph_Time_Table& g);
+protected:
+	enum Section { OFFSET, TARGET, WEIGHT, T0, PERIOD, DURATION, NUM_SECTIONS };
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t kind;
+		uint32_t byteOrder;
+		uint32_t reserved;
+		uint64_t numNodes;
+		uint64_t numEdges;
+		uint64_t section[NUM_SECTIONS];
+	};
+	/* Values stored for each edge, and the section of each value */
+	struct UnweightedFields {
+		static const uint count = 1;
+		static Section section(uint) {return TARGET;}
+		template<typename It>
+		static uint32_t get(It e, uint) {return *e;}
+	};
+	struct WeightedFields {
+		static const uint count = 2;
+		static Section section(uint k) {return k == 0 ? TARGET : WEIGHT;}
+		template<typename It>
+		static uint32_t get(It e, uint k) {return k == 0 ? e->first : (uint32_t)e->second;}
+	};
+	struct TimeTableFields {
+		static const uint count = 4;
+		static Section section(uint k) {return k == 0 ? TARGET : k == 1 ? T0 : k == 2 ? PERIOD : DURATION;}
+		template<typename It>
+		static uint32_t get(It e, uint k) {return k == 0 ? e->v : k == 1 ? e->t0 : k == 2 ? e->P : e->d;}
+	};
+	/* Buffered output of uint32 values */
+	class Writer {
+		FILE* f;
+		vector<uint32_t> buf;
+		uint64_t pos;
+	public:
+		bool ok;
+		Writer(FILE* f) : f(f), pos(0), ok(true) {buf.reserve(1 << 16);}
+		void put(uint32_t x) {buf.push_back(x); if (buf.size() == buf.capacity()) flush();}
+		void bytes(const void* p, size_t n);
+		void pad(uint64_t to);
+		void flush();
+	};
+	template<typename Fields, typename Adj>
+	static bool write_graph(const char* path, Kind kind, uint n, const Adj& g);
+	static std::shared_ptr<const MappedFile> open(const char* path, Kind kind, const Header*& h);
+	static bool check_edges(const Header* h, const char* base);
+	static uint64_t align(uint64_t x) {return (x + 63) / 64 * 64;}
+	static const uint32_t byteOrderMark = 0x01020304;
+};
+
+
+
+/* @brief: Write g to a file at path, overwriting it
+ * @return: false if the file could not be written */
+bool GraphFile::write(const char* path, const GraphD& g) {
+	if (g.isFrozen()) return write_graph<UnweightedFields>(path, UNWEIGHTED, g.size(), g.getCompact());
+	return write_graph<UnweightedFields>(path, UNWEIGHTED, g.size(), g);
+}
+
+bool GraphFile::write(const char* path, const GraphWD& g) {
+	if (g.isFrozen()) return write_graph<WeightedFields>(path, WEIGHTED_DIRECTED, g.size(), g.getCompact());
+	return write_graph<WeightedFields>(path, WEIGHTED_DIRECTED, g.size(), g);
+}
+
+/* Each edge of an undirected graph is stored in both directions, like in the graph */
+bool GraphFile::write(const char* path, const GraphWU& g) {
+	if (g.isFrozen()) return write_graph<WeightedFields>(path, WEIGHTED_UNDIRECTED, g.size(), g.getCompact());
+	return write_graph<WeightedFields>(path, WEIGHTED_UNDIRECTED, g.size(), g);
+}
+
+bool GraphFile::write(const char* path, const Graph_Time_Table& g) {
+	return write_graph<TimeTableFields>(path, TIME_TABLE, g.size(), g);
+}
+
+/* @brief: Make g a frozen graph whose edges are a view of the file at path, without copying them
+ * @param: check - also check that the offsets are nondecreasing and every target is a node,
+ * which reads the whole file
+ * @return: false if the file could not be mapped or does not hold a graph of this kind,
+ * in which case g is left unchanged */
+bool GraphFile::map(const char* path, GraphD& g, bool check) {
+	const Header* h;
+	auto file = open(path, UNWEIGHTED, h);
+	if (!file || (check && !check_edges(h, file->begin()))) return false;
+	CompactAdjacency csr;
+	csr.view(h->numNodes, (const uint*)(file->begin() + h->section[OFFSET]),
+			(const uint*)(file->begin() + h->section[TARGET]), file);
+	g.setCompact(std::move(csr));
+	return true;
+}
+
+bool GraphFile::map(const char* path, GraphWD& g, bool check) {
+	const Header* h;
+	auto file = open(path, WEIGHTED_DIRECTED, h);
+	if (!file || (check && !check_edges(h, file->begin()))) return false;
+	CompactGraph csr;
+	csr.view(h->numNodes, (const uint*)(file->begin() + h->section[OFFSET]),
+			(const uint*)(file->begin() + h->section[TARGET]),
+			(const int*)(file->begin() + h->section[WEIGHT]), file);
+	g.setCompact(std::move(csr));
+	return true;
+}
+
+/* A file of a GraphWD, which is mapped as a GraphWDP without checking that the weights are nonnegative */
+bool GraphFile::map(const char* path, GraphWDP& g, bool check) {
+	GraphWD tmp(0);
+	if (!map(path, tmp, check)) return false;
+	g.setCompact(tmp.getCompact());
+	return true;
+}
+
+bool GraphFile::map(const char* path, GraphWU& g, bool check) {
+	const Header* h;
+	auto file = open(path, WEIGHTED_UNDIRECTED, h);
+	if (!file || (check && !check_edges(h, file->begin()))) return false;
+	CompactGraph csr;
+	csr.view(h->numNodes, (const uint*)(file->begin() + h->section[OFFSET]),
+			(const uint*)(file->begin() + h->section[TARGET]),
+			(const int*)(file->begin() + h->section[WEIGHT]), file);
+	g.setCompact(std::move(csr));
+	return true;
+}
+
+/* @brief: Reset g to the time table in the file at path. The edges are copied, since
+ * Graph_Time_Table keeps them in per-node edge lists
+ * @return: false if the file could not be mapped or does not hold a time table,
+ * in which case g is left unchanged */
+bool GraphFile::read(const char* path, Graph_Time_Table& g) {
+	const Header* h;
+	auto file = open(path, TIME_TABLE, h);
+	if (!file || !check_edges(h, file->begin())) return false;
+	const uint* offset = (const uint*)(file->begin() + h->section[OFFSET]);
+	const uint* field[4];
+	for (uint k = 0; k < TimeTableFields::count; ++k)
+		field[k] = (const uint*)(file->begin() + h->section[TimeTableFields::section(k)]);
+	g.reset(h->numNodes);
+	for (uint u = 0; u < h->numNodes; ++u)
+		for (uint i = offset[u]; i < offset[u+1]; ++i)
+			g.addEdge(u, field[0][i], field[1][i], field[2][i], field[3][i]);
+	return true;
+}
+
+template<typename Fields, typename Adj>
+bool GraphFile::write_graph(const char* path, Kind kind, uint n, const Adj& g) {
+	vector<uint32_t> offset(n+1);
+	offset[0] = 0;
+	for (uint u = 0; u < n; ++u) {
+		uint d = 0;
+		for (auto e = g.begin(u); e != g.end(u); ++e) ++d;
+		offset[u+1] = offset[u] + d;
+	}
+	Header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, "GRAPHBIN", 8);
+	h.version = version;
+	h.kind = kind;
+	h.byteOrder = byteOrderMark;
+	h.numNodes = n;
+	h.numEdges = offset[n];
+	uint64_t pos = align(sizeof(Header));
+	h.section[OFFSET] = pos;
+	pos = align(pos + 4*(h.numNodes+1));
+	for (uint k = 0; k < Fields::count; ++k) {
+		h.section[Fields::section(k)] = pos;
+		pos = align(pos + 4*h.numEdges);
+	}
+	FILE* f = fopen(path, "wb");
+	if (!f) return false;
+	Writer out(f);
+	out.bytes(&h, sizeof(h));
+	out.pad(h.section[OFFSET]);
+	for (uint u = 0; u <= n; ++u)
+		out.put(offset[u]);
+	//one pass over the edges per section, so the file is written sequentially
+	for (uint k = 0; k < Fields::count; ++k) {
+		out.pad(h.section[Fields::section(k)]);
+		for (uint u = 0; u < n; ++u)
+			for (auto e = g.begin(u); e != g.end(u); ++e)
+				out.put(Fields::get(e, k));
+	}
+	out.flush();
+	bool ok = out.ok;
+	if (fclose(f) != 0) ok = false;
+	if (!ok) std::remove(path);
+	return ok;
+}
+
+/* @brief: Map the file at path and check its header and the sizes of its sections
+ * @param: h - is set to the header of the file
+ * @return: The mapped file, or null if it is not a valid file of the given kind */
+std::shared_ptr<const MappedFile> GraphFile::open(const char* path, Kind kind, const Header*& h) {
+	std::shared_ptr<MappedFile> file(new MappedFile());
+	if (!file->open(path) || file->size() < sizeof(Header)) return nullptr;
+	h = (const Header*)file->begin();
+	if (memcmp(h->magic, "GRAPHBIN", 8) != 0 || h->version != version
+			|| h->byteOrder != byteOrderMark || h->kind != (uint32_t)kind)
+		return nullptr;
+	if (h->numNodes >= std::numeric_limits<uint>::max() || h->numEdges > std::numeric_limits<uint>::max())
+		return nullptr;
+	bool weighted = kind == WEIGHTED_DIRECTED || kind == WEIGHTED_UNDIRECTED;
+	bool timeTable = kind == TIME_TABLE;
+	bool present[NUM_SECTIONS] = {true, true, weighted, timeTable, timeTable, timeTable};
+	for (uint k = 0; k < NUM_SECTIONS; ++k) {
+		uint64_t count = k == OFFSET ? h->numNodes+1 : h->numEdges;
+		if (!present[k]) continue;
+		if (h->section[k] % 64 != 0 || h->section[k] < sizeof(Header)
+				|| h->section[k] > file->size() || file->size() - h->section[k] < 4*count)
+			return nullptr;
+	}
+	const uint* offset = (const uint*)(file->begin() + h->section[OFFSET]);
+	if (offset[0] != 0 || offset[h->numNodes] != h->numEdges) return nullptr;
+	return file;
+}
+
+/* @return: Whether the offsets are nondecreasing and every target is a node */
+bool GraphFile::check_edges(const Header* h, const char* base) {
+	const uint* offset = (const uint*)(base + h->section[OFFSET]);
+	const uint* target = (const uint*)(base + h->section[TARGET]);
+	for (uint u = 0; u < h->numNodes; ++u)
+		if (offset[u] > offset[u+1]) return false;
+	for (uint i = 0; i < h->numEdges; ++i)
+		if (target[i] >= h->numNodes) return false;
+	return true;
+}
+
+/* Write n raw bytes */
+void GraphFile::Writer::bytes(const void* p, size_t n) {
+	flush();
+	if (ok && fwrite(p, 1, n, f) != n) ok = false;
+	pos += n;
+}
+
+/* Write zeros up to byte offset to */
+void GraphFile::Writer::pad(uint64_t to) {
+	flush();
+	static const char zeros[64] = {};
+	if (ok && to > pos && fwrite(zeros, 1, to - pos, f) != to - pos) ok = false;
+	pos = max(pos, to);
+}
+
+/* Write the buffered values */
+void GraphFile::Writer::flush() {
+	if (ok && !buf.empty() && fwrite(buf.data(), 4, buf.size(), f) != buf.size()) ok = false;
+	pos += 4*buf.size();
+	buf.clear();
+}
+
+
+} //namespace graph
+
+#endif /* GRAPHFILE_H_ */
@@ -14,6 +14,9 @@
 #include <stack>
 #include <queue>
 #include <set>
+#include <cstddef>
+#include <type_traits>
+#include <cassert>
 
 namespace graph {
 
@@ -30,6 +33,90 @@ typedef unsigned int uint;
 const int inf = std::numeric_limits<int>::max();
 const int neginf = -inf;
 
+
+/*** WeightTraits ***/
+
+/* @brief: Path length arithmetic for edge weights of type Weight. Path lengths are kept in
+ * Distance, which is signed and at least as wide as int, and the largest Distance (infinity for
+ * floating point weights) stands for no path like graph::inf does for int weights.
+ * Sums saturate at inf and neginf instead of wrapping around, so a path too long to represent
+ * is taken as no path rather than as a short or negative one
+ * @notes: Unsigned 32 bit weights get long long distances */
+template<typename Weight>
+struct WeightTraits {
+	static_assert(std::is_signed<Weight>::value || sizeof(Weight) < sizeof(long long),
+			"unsigned 64 bit weights do not fit a signed distance");
+	typedef typename std::conditional<!std::is_integral<Weight>::value, Weight,
+			typename std::conditional<(sizeof(Weight) < sizeof(int)), int,
+			typename std::conditional<std::is_signed<Weight>::value, Weight, long long>::type>::type>::type Distance;
+	static constexpr Distance inf() {
+		return std::numeric_limits<Distance>::has_infinity ? std::numeric_limits<Distance>::infinity()
+				: std::numeric_limits<Distance>::max();
+	}
+	static constexpr Distance neginf() {return -inf();}
+	/* Whether distances fit the 32 bit keys of RadixHeap and BucketQueue */
+	static constexpr bool smallKeys = std::is_integral<Distance>::value && sizeof(Distance) <= sizeof(uint);
+	static Distance add(Distance d, Distance w);
+	template<typename T>
+	static Distance clamp(T x) {return x >= inf() ? inf() : x <= neginf() ? neginf() : (Distance)x;}
+};
+
+/* @brief: d + w, saturated to [neginf,inf]
+ * @param: d - a finite distance */
+template<typename Weight>
+typename WeightTraits<Weight>::Distance WeightTraits<Weight>::add(Distance d, Distance w) {
+	if (!std::numeric_limits<Distance>::is_integer) return d + w;
+	//narrow sums are formed in long long, which is branch free
+	if (sizeof(Distance) < sizeof(long long)) return clamp((long long)d + (long long)w);
+	if (w > 0) return d >= inf() - w ? inf() : d + w;
+	return d <= neginf() - w ? neginf() : d + w;
+}
+
+template<typename Weight>
+constexpr bool WeightTraits<Weight>::smallKeys;
+
+
+/*** NodeTraits ***/
+
+/* @brief: Limits of the type Node in which graphs store the destination of each edge, and the
+ * type Index in which their results store nodes. Index is Node if it is narrower than int and
+ * int otherwise, and all ones, i.e. (Index)-1, stands for no node */
+template<typename Node>
+struct NodeTraits {
+	/* Whether Node is unsigned and at most as wide as uint, which the graphs require */
+	static constexpr bool valid = std::is_unsigned<Node>::value && sizeof(Node) <= sizeof(uint);
+	typedef typename std::conditional<(sizeof(Node) < sizeof(int)), Node, int>::type Index;
+	/* @return: Whether nodes 0 .. n-1 can all be stored as Node and Index, with all ones left for no node */
+	static bool holds(uint n) {return sizeof(Node) >= sizeof(uint) || n <= std::numeric_limits<Node>::max();}
+};
+
+template<typename Node>
+constexpr bool NodeTraits<Node>::valid;
+
+
+/*** AlignedAllocator ***/
+
+/* @brief: Allocator for std::vector whose storage starts at a multiple of Align bytes,
+ * e.g. a cache line so that rows of a matrix can be loaded with aligned vector instructions */
+template<typename T, std::size_t Align>
+struct AlignedAllocator {
+	typedef T value_type;
+	template<typename U> struct rebind {typedef AlignedAllocator<U,Align> other;};
+	AlignedAllocator() {}
+	template<typename U> AlignedAllocator(const AlignedAllocator<U,Align>&) {}
+	T* allocate(std::size_t n) {
+		//over-allocate and keep the pointer to free just before the aligned block
+		char* raw = static_cast<char*>(::operator new(n*sizeof(T) + Align + sizeof(void*)));
+		std::size_t p = reinterpret_cast<std::size_t>(raw + sizeof(void*));
+		p = (p + Align - 1) / Align * Align;
+		reinterpret_cast<void**>(p)[-1] = raw;
+		return reinterpret_cast<T*>(p);
+	}
+	void deallocate(T* p, std::size_t) {::operator delete(reinterpret_cast<void**>(p)[-1]);}
+	template<typename U> bool operator==(const AlignedAllocator<U,Align>&) const {return true;}
+	template<typename U> bool operator!=(const AlignedAllocator<U,Align>&) const {return false;}
+};
+
 } //namespace graph
 
 #endif /* GRAPHUTIL_H_ */
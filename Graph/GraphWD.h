@@ -9,141 +9,636 @@
 #define GRAPHWD_H_
 
 #include "GraphUtil.h"
+#include "CompactGraph.h"
 #include "PathMatrix.h"
 #include "PathVector.h"
+#include "NodeOrder.h"
+#include "SearchWorkspace.h"
+#include "Parallel.h"
+#include "IndexedHeap.h"
+#include <atomic>
+#include <mutex>
+#include <cstdint>
 
 namespace graph {
 
 /*** GraphWD ***/
 
 /* @brief: Weighted Directed Graph allowing positive and negative edge weights
- * @notes: If only positive edges are used, consider using GraphWDP for speed */
-class GraphWD {
+ * @param: Weight - the type of the edge weights. Distances are of the type WeightTraits<Weight>::Distance,
+ * and inf and neginf are the members of the same name rather than graph::inf and graph::neginf
+ * @param: Node - the type in which the destination of each edge is stored, unsigned and at most as wide as uint.
+ * Results store nodes in NodeTraits<Node>::Index, so a narrow Node makes them smaller too.
+ * A narrow Node allows at most numeric_limits<Node>::max() nodes, which is asserted
+ * Narrow weights and nodes make the edges smaller, so searches read less memory
+ * @notes: If only positive edges are used, consider using GraphWDP for speed.
+ * GraphWD is BasicGraphWD<int,uint> */
+template<typename Weight = int, typename Node = uint>
+class BasicGraphWD {
+	static_assert(NodeTraits<Node>::valid, "Node must be unsigned and at most as wide as uint");
 public:
-	typedef pair<uint,int> EdgePair; // first: destination node  second: edge weight
+	typedef WeightTraits<Weight> Traits;
+	typedef typename Traits::Distance Distance;
+	typedef pair<Node,Weight> EdgePair; // first: destination node  second: edge weight
 	typedef vector<EdgePair> EdgeList;
+	typedef BasicCompactGraph<Weight,Node> CompactGraph;
+	typedef BasicPathVector<Distance, typename NodeTraits<Node>::Index> PathVector;
+	typedef BasicPathMatrix<Distance, typename NodeTraits<Node>::Index> PathMatrix;
+	typedef BasicSearchWorkspace<Distance> SearchWorkspace;
+	static constexpr Distance inf = Traits::inf();
+	static constexpr Distance neginf = Traits::neginf();
 protected:
 	uint N;
 	vector<EdgeList> edges;
+	CompactGraph csr; /* holds the edges instead of 'edges' while frozen */
+	bool frozen;
+	uint64_t version; /* counts changes to the edges from 1, so data derived from them can tell it is stale */
 public:
-	GraphWD(uint n) : N(n), edges(n) {}
+	BasicGraphWD(uint n) : N(n), edges(n), frozen(false), version(1) {assert(NodeTraits<Node>::holds(n));}
 	void reset(uint n);
-	/* Add edge from u to v with weight w */
-	void addEdge(uint u, uint v, int w) {edges[u].push_back(EdgePair(v,w));}
-	/* @return: Begin Iterator for edges going from node u */
-	EdgeList::const_iterator begin(uint u) const {return edges[u].begin();}
-	/* @return: Beyond-end Iterator for edges going from node u */
-	EdgeList::const_iterator end(uint u) const {return edges[u].end();}
-	void getShortestDistance(PathMatrix& P) const;
+	/* @return: Number of nodes */
+	uint size() const {return N;}
+	/* Add edge from u to v with weight w. The graph must not be frozen */
+	void addEdge(uint u, uint v, Weight w) {edges[u].push_back(EdgePair(v,w)); ++version;}
+	bool removeEdge(uint u, uint v, Weight w);
+	/* @return: Begin Iterator for edges going from node u. Use getCompact() while frozen */
+	typename EdgeList::const_iterator begin(uint u) const {return edges[u].begin();}
+	/* @return: Beyond-end Iterator for edges going from node u. Use getCompact() while frozen */
+	typename EdgeList::const_iterator end(uint u) const {return edges[u].end();}
+	void freeze();
+	void thaw();
+	void permute(const NodeOrder& P);
+	bool isFrozen() const {return frozen;}
+	/* @return: The packed edges, only valid while frozen */
+	const CompactGraph& getCompact() const {return csr;}
+	void setCompact(CompactGraph g);
+	void getShortestDistance(PathMatrix& P, uint numThreads = 0) const;
 	void getShortestDistance(uint s, PathVector& P) const;
+	void getShortestDistance(uint s, SearchWorkspace& W) const;
+	void getShortestDistanceSparse(PathMatrix& P, uint numThreads = 0) const;
+	void getShortestDistanceBatch(const vector<uint>& sources, vector<PathVector>& P, uint numThreads = 0) const;
+	void getShortestDistanceTable(const vector<uint>& sources, const vector<uint>& targets,
+			vector<Distance>& table, uint numThreads = 0) const;
+	template<typename RowCallback>
+	void getShortestDistanceRows(RowCallback f, uint numThreads = 0) const;
+protected:
+	/* Johnson's potentials, integers are kept in long long so that reweighted paths do not overflow */
+	typedef typename std::conditional<std::numeric_limits<Distance>::is_integer, long long, Distance>::type Potential;
+	template<typename Adj, typename Labels>
+	void bellman_ford(const Adj& g, uint s, Labels& L, vector<uint>& buffer) const;
+	template<typename Adj>
+	void bellman_ford_batch(const Adj& g, const vector<uint>& sources, PathVector* P,
+			const vector<uint>* targets, Distance* table, uint numThreads) const;
+	template<typename Adj>
+	void floyd_warshall(const Adj& g, PathMatrix& P, uint numThreads) const;
+	template<typename Pred, typename Adj>
+	void fw_solve(const Adj& g, PathMatrix& P, uint numThreads) const;
+	template<typename Adj>
+	void johnson(const Adj& g, PathMatrix& P, uint numThreads) const;
+	template<typename Pred, typename Adj>
+	void johnson_solve(const Adj& g, const vector<Potential>& h, PathMatrix& P, uint numThreads) const;
+	template<typename Adj>
+	bool potentials(const Adj& g, vector<Potential>& h) const;
+	template<typename Pred, typename Adj>
+	void johnson_row(const Adj& g, const vector<Potential>& h, uint s, vector<Potential>& dist,
+			IndexedHeap<Potential>& q, Distance* ds, Pred* ps) const;
+	template<typename Adj, typename RowCallback>
+	void stream_rows(const Adj& g, RowCallback& f, uint numThreads) const;
+	template<typename Pred>
+	static void fw_block(PathMatrix& P, uint i0, uint i1, uint j0, uint j1, uint k0, uint k1);
+	template<typename Pred>
+	static void fw_relax_row(Distance* __restrict di, Pred* __restrict pi, const Distance* __restrict dk,
+			const Pred* __restrict pk, Distance a, uint j0, uint j1);
 };
 
+typedef BasicGraphWD<> GraphWD;
+
+
+template<typename Weight, typename Node>
+constexpr typename BasicGraphWD<Weight,Node>::Distance BasicGraphWD<Weight,Node>::inf;
+template<typename Weight, typename Node>
+constexpr typename BasicGraphWD<Weight,Node>::Distance BasicGraphWD<Weight,Node>::neginf;
+
 
 
 
 /* Reset a Graph to another size to save unnecessary reallocation ;) */
-void GraphWD::reset(uint n) {
+template<typename Weight, typename Node>
+void BasicGraphWD<Weight,Node>::reset(uint n) {
+	assert(NodeTraits<Node>::holds(n));
+	if (frozen) {csr.clear(); frozen = false;}
 	edges.resize(n);
 	N = n;
+	++version;
 	for (uint i = 0; i < n; ++i)
 		edges[i].clear();
 }
 
+/* @brief: Remove one edge from u to v with weight w. The other edges keep their order.
+ * The graph must not be frozen
+ * @return: false if there is no such edge */
+template<typename Weight, typename Node>
+bool BasicGraphWD<Weight,Node>::removeEdge(uint u, uint v, Weight w) {
+	auto it = std::find(edges[u].begin(), edges[u].end(), EdgePair(v,w));
+	if (it == edges[u].end()) return false;
+	edges[u].erase(it);
+	++version;
+	return true;
+}
+
+/* @brief: Packs all edges into contiguous arrays (see CompactGraph) and releases the
+ * per-node edge lists. Queries on a frozen graph stream through memory and are faster
+ * on large graphs. Call thaw() before adding more edges */
+template<typename Weight, typename Node>
+void BasicGraphWD<Weight,Node>::freeze() {
+	if (frozen) return;
+	csr.assign(edges);
+	vector<EdgeList>().swap(edges);
+	frozen = true;
+}
+
+/* @brief: Replaces the graph by the packed edges g, leaving it frozen with g.size() nodes.
+ * If g is a view, e.g. of a mapped file (see GraphFile), the edges are not copied
+ * and the graph only reads from the memory of the view */
+template<typename Weight, typename Node>
+void BasicGraphWD<Weight,Node>::setCompact(CompactGraph g) {
+	assert(NodeTraits<Node>::holds(g.size()));
+	vector<EdgeList>().swap(edges);
+	N = g.size();
+	csr = std::move(g);
+	frozen = true;
+	++version;
+}
+
+/* @brief: Renumbers every node v to P.newId(v), keeping the order of the edges of each node.
+ * A frozen graph stays frozen, with its packed edges rebuilt
+ * @param: P - an order of the nodes of this graph, see NodeOrder */
+template<typename Weight, typename Node>
+void BasicGraphWD<Weight,Node>::permute(const NodeOrder& P) {
+	++version;
+	if (frozen) {csr.permute(P.getPermutation()); return;}
+	vector<EdgeList> e(N);
+	for (uint u = 0; u < N; ++u) {
+		EdgeList& l = e[P.newId(u)];
+		l.swap(edges[u]);
+		for (auto& x : l)
+			x.first = P.newId(x.first);
+	}
+	edges.swap(e);
+}
+
+/* @brief: Moves the packed edges back into per-node edge lists so that edges can be added again */
+template<typename Weight, typename Node>
+void BasicGraphWD<Weight,Node>::thaw() {
+	if (!frozen) return;
+	csr.unpack(edges);
+	csr.clear();
+	frozen = false;
+}
+
 /* Updates the passed PathVector object to contain the shortest paths between s and all other nodes.
  * If no path exists, the distance is graph::inf, if an infinitely short path exists, the distance is graph::neginf
  * @param: s - source node
  * @param: P - Path object to contain the result
- * @notes: Implemented using Bellman-Ford's algorithm */
-void GraphWD::getShortestDistance(uint s, PathVector& P) const {
-	auto& dist = P.dist;
-	auto& prev = P.prev;
-	P.u = s;
-	dist.assign(N,inf);
-	prev.assign(N,-1);
-	dist[s] = 0;
-	uint v;
-	int w;
-	bool endEarly; /* for optimization */
-	//go through graph N times and update distances
-	for (uint i = 0; i < N; ++i) {
-		endEarly = true;
-		for (uint u = 0; u < N; ++u){
-			if (dist[u] == inf) continue;
-			for (auto e = begin(u); e != end(u); ++e) {
-				v = e->first;
-				w = e->second;
-				if (dist[u] + w < dist[v]) {
-					endEarly = false;
-					dist[v] = dist[u] + w;
-					prev[v] = u;
-				}
+ * @notes: Implemented using Bellman-Ford's algorithm with a FIFO queue of the nodes whose distance
+ * changed. When a node improves, its subtree in the shortest path tree is taken out until it is
+ * reached again, and an edge into that subtree from the node's own subtree is a negative cycle,
+ * so cycles are found as soon as they form and everything reachable from them is marked at once */
+template<typename Weight, typename Node>
+void BasicGraphWD<Weight,Node>::getShortestDistance(uint s, PathVector& P) const {
+	vector<uint> buffer;
+	if (frozen) bellman_ford(csr, s, P, buffer);
+	else bellman_ford(*this, s, P, buffer);
+}
+
+/* @brief: Like getShortestDistance(uint, PathVector&), but the result is kept in a SearchWorkspace
+ * so that the search takes time proportional to the number of nodes and edges reachable from s
+ * @param: s - source node
+ * @param: W - workspace to contain the result, reusable for any number of searches */
+template<typename Weight, typename Node>
+void BasicGraphWD<Weight,Node>::getShortestDistance(uint s, SearchWorkspace& W) const {
+	if (frozen) bellman_ford(csr, s, W, W.buffer);
+	else bellman_ford(*this, s, W, W.buffer);
+}
+
+/* @brief: Runs getShortestDistance(uint, PathVector&) from each of the sources, spread over a
+ * number of threads that each reuse their own scratch arrays
+ * @param: sources - source nodes
+ * @param: P - receives the result for sources[i] in P[i]. It is resized to the number of sources,
+ * and the PathVectors already in it are reused without reallocating
+ * @param: numThreads - number of threads to use, 0 for one per hardware thread */
+template<typename Weight, typename Node>
+void BasicGraphWD<Weight,Node>::getShortestDistanceBatch(const vector<uint>& sources, vector<PathVector>& P, uint numThreads) const {
+	P.resize(sources.size());
+	if (frozen) bellman_ford_batch(csr, sources, P.data(), 0, 0, numThreads);
+	else bellman_ford_batch(*this, sources, P.data(), 0, 0, numThreads);
+}
+
+/* @brief: Finds the shortest distance from each of the sources to each of the targets, spread
+ * over a number of threads like getShortestDistanceBatch
+ * @param: sources - source nodes
+ * @param: targets - target nodes
+ * @param: table - receives the distance from sources[i] to targets[j] in table[i*targets.size() + j],
+ * graph::inf if there is no path and graph::neginf if it is infinitely short
+ * @param: numThreads - number of threads to use, 0 for one per hardware thread */
+template<typename Weight, typename Node>
+void BasicGraphWD<Weight,Node>::getShortestDistanceTable(const vector<uint>& sources, const vector<uint>& targets,
+		vector<Distance>& table, uint numThreads) const {
+	table.resize(sources.size() * targets.size());
+	if (frozen) bellman_ford_batch(csr, sources, 0, &targets, table.data(), numThreads);
+	else bellman_ford_batch(*this, sources, 0, &targets, table.data(), numThreads);
+}
+
+/* Writes the result for sources[i] to P[i] if P is given, otherwise the distances to the targets to row i of table */
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicGraphWD<Weight,Node>::bellman_ford_batch(const Adj& g, const vector<uint>& sources, PathVector* P,
+		const vector<uint>* targets, Distance* table, uint numThreads) const {
+	uint T = min<size_t>(getNumThreads(numThreads), max<size_t>(1, sources.size()));
+	vector<vector<uint> > scratch(T);
+	vector<PathVector> result(P ? 0 : T);
+	runTasks(sources.size(), T, [&](uint i, uint t) {
+		PathVector& res = P ? P[i] : result[t];
+		bellman_ford(g, sources[i], res, scratch[t]);
+		if (table)
+			for (size_t j = 0; j < targets->size(); ++j)
+				table[i*targets->size() + j] = res.dist[(*targets)[j]];
+	});
+}
+
+template<typename Weight, typename Node>
+template<typename Adj, typename Labels>
+void BasicGraphWD<Weight,Node>::bellman_ford(const Adj& g, uint s, Labels& L, vector<uint>& buffer) const {
+	enum : uint {inTree = 1, queued = 2};
+	L.start(N,s);
+	/* The shortest path tree is kept as a circular list in preorder with the depth of each
+	 * node, so the subtree of v is v followed by the nodes deeper than v. Nothing in the
+	 * buffer is read for a node before the node is reached, so it needs no initialization */
+	if (buffer.size() < 5*(size_t)N) buffer.resize(5*(size_t)N);
+	uint* next = buffer.data();
+	uint* before = next + N;
+	uint* depth = before + N;
+	uint* queue = depth + N; /* circular, each node is queued at most once */
+	uint* flags = queue + N;
+	vector<uint> stack;
+	uint head = 0, count = 0;
+	auto label = [&](uint v, Distance d, int p) {
+		if (!L.reached(v)) flags[v] = 0;
+		L.set(v,d,p);
+	};
+	label(s,0,-1);
+	next[s] = before[s] = s;
+	depth[s] = 0;
+	flags[s] = inTree | queued;
+	queue[0] = s;
+	count = 1;
+	//marks every node reachable from u as neginf and removes it from the tree
+	auto markNegative = [&](uint u) {
+		label(u,neginf,-1);
+		stack.push_back(u);
+		while (!stack.empty()) {
+			uint x = stack.back();
+			stack.pop_back();
+			if (flags[x] & inTree) {
+				next[before[x]] = next[x];
+				before[next[x]] = before[x];
+				flags[x] &= ~inTree;
 			}
+			for (auto e = g.begin(x); e != g.end(x); ++e)
+				if (L.distance(e->first) != neginf) {
+					label(e->first,neginf,-1);
+					stack.push_back(e->first);
+				}
 		}
-		if (endEarly) return; /* If no change happened, we are done */
-	}
-	//one more iteration to check for infinite cycles
-	for (uint u = 0; u < N; ++u){
-		if (dist[u] == inf) continue;
-		for (auto e = begin(u); e != end(u); ++e) {
-			v = e->first;
-			w = e->second;
-			if (dist[u] == neginf || dist[u] + w < dist[v]) {
-				dist[u] = neginf;
-				dist[v] = neginf;
+	};
+	while (count > 0) {
+		uint u = queue[head];
+		head = head+1 == N ? 0 : head+1;
+		--count;
+		flags[u] &= ~queued;
+		if (!(flags[u] & inTree)) continue; /* an ancestor improved since u was queued, u will be reached again */
+		Distance du = L.distance(u);
+		for (auto e = g.begin(u); e != g.end(u); ++e) {
+			uint v = e->first;
+			Distance newDist = Traits::add(du, e->second);
+			Distance dv = L.distance(v);
+			if (dv == neginf || newDist >= dv) continue;
+			if (dv != inf && (flags[v] & inTree)) {
+				//disassemble the subtree of v, their distances are about to improve through v
+				bool cycle = u == v;
+				uint x = next[v];
+				while (depth[x] > depth[v]) {
+					cycle |= x == u;
+					flags[x] &= ~inTree;
+					x = next[x];
+				}
+				next[before[v]] = x;
+				before[x] = before[v];
+				flags[v] &= ~inTree;
+				if (cycle) { /* u is a descendant of v, so the edge closes a negative cycle */
+					markNegative(v);
+					break;
+				}
+			}
+			if (newDist == neginf) { /* too short to represent, taken as infinitely short */
+				markNegative(v);
+				continue;
+			}
+			label(v,newDist,u);
+			next[v] = next[u];
+			before[next[u]] = v;
+			next[u] = v;
+			before[v] = u;
+			depth[v] = depth[u]+1;
+			flags[v] |= inTree;
+			if (!(flags[v] & queued)) {
+				queue[(head+count) % N] = v;
+				flags[v] |= queued;
+				++count;
 			}
 		}
 	}
-
 }
 
 /* @brief: Updates the passed PathMatrix object to contain shortest distance between all pairs of nodes.
  * If a infinitely short path exists, the distance is graph::neginf.
  * If no path exists, the distance is graph::inf
- * @notes: Implemented using the Floyd-Warshall algorithm */
-void GraphWD::getShortestDistance(PathMatrix& P) const {
-	auto& dist = P.dist;
-	auto& prev = P.prev;
-	dist.resize(N); prev.resize(N);
-	//initialize DP matrix with weights
-	for (uint u = 0; u < N; ++u) {
-		dist[u].assign(N,inf);
-		prev[u].assign(N,-1);
-		for (auto edge = begin(u); edge != end(u); ++edge){
-			uint v = edge->first;
-			//In case of parallel edges
-			if (edge->second < dist[u][v]) {
-				dist[u][v] = edge->second;
-				prev[u][v] = u;
+ * @param: P - the result, keeping the predecessors its PathMode asks for
+ * @param: numThreads - number of threads to use, 0 for one per hardware thread
+ * @notes: Implemented using the Floyd-Warshall algorithm, blocked so that the matrix is
+ * processed in cache-sized tiles which are spread over the threads */
+template<typename Weight, typename Node>
+void BasicGraphWD<Weight,Node>::getShortestDistance(PathMatrix& P, uint numThreads) const {
+	if (frozen) floyd_warshall(csr, P, numThreads);
+	else floyd_warshall(*this, P, numThreads);
+}
+
+/* Runs Floyd-Warshall with the predecessor type of the mode of P */
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicGraphWD<Weight,Node>::floyd_warshall(const Adj& g, PathMatrix& P, uint numThreads) const {
+	P.resize(N);
+	if (P.predSize == 1) fw_solve<uint8_t>(g, P, numThreads);
+	else if (P.predSize == 2) fw_solve<uint16_t>(g, P, numThreads);
+	else fw_solve<int>(g, P, numThreads);
+}
+
+template<typename Weight, typename Node>
+template<typename Pred, typename Adj>
+void BasicGraphWD<Weight,Node>::fw_solve(const Adj& g, PathMatrix& P, uint numThreads) const {
+	const uint B = 64; /* tile size, three 64x64 tiles fit in L2 */
+	const Pred none = (Pred)-1;
+	uint nb = (N + B - 1) / B;
+	uint T = min(getNumThreads(numThreads), max(1u,nb));
+	vector<uint> negative; /* nodes on negative cycles */
+	vector<char> reach; /* for each node in negative, whether it reaches each node */
+	Barrier barrier(T);
+	runThreads(T, [&](uint t) {
+		//initialize DP matrix with weights
+		for (uint u = t; u < N; u += T) {
+			Distance* du = &P.dist[P.index(u,0)];
+			Pred* pu = P.template predecessors<Pred>(u);
+			std::fill(du, du + N, inf);
+			if (pu) std::fill(pu, pu + N, none);
+			for (auto edge = g.begin(u); edge != g.end(u); ++edge){
+				uint v = edge->first;
+				//In case of parallel edges
+				if (edge->second < du[v]) {
+					du[v] = edge->second;
+					if (pu) pu[v] = u;
+				}
+			}
+			//In case of positive self-loops
+			if (du[u] > 0){
+				du[u] = 0;
+				if (pu) pu[u] = none;
+			}
+		}
+		barrier.wait();
+		//DP, one block of intermediate nodes k at a time
+		for (uint kb = 0; kb < nb; ++kb) {
+			uint k0 = kb*B, k1 = min(N,k0+B);
+			//the diagonal tile only depends on itself
+			if (t == 0) fw_block<Pred>(P,k0,k1,k0,k1,k0,k1);
+			barrier.wait();
+			//tiles in the same row or column depend on themselves and the diagonal tile
+			for (uint b = t; b < nb; b += T) {
+				if (b == kb) continue;
+				uint b0 = b*B, b1 = min(N,b0+B);
+				fw_block<Pred>(P,k0,k1,b0,b1,k0,k1);
+				fw_block<Pred>(P,b0,b1,k0,k1,k0,k1);
+			}
+			barrier.wait();
+			//the remaining tiles depend on the tiles in their row and column
+			for (uint ib = t; ib < nb; ib += T) {
+				if (ib == kb) continue;
+				uint i0 = ib*B, i1 = min(N,i0+B);
+				for (uint jb = 0; jb < nb; ++jb)
+					if (jb != kb) fw_block<Pred>(P,i0,i1,jb*B,min(N,jb*B+B),k0,k1);
 			}
+			barrier.wait();
 		}
-		//In case of positive self-loops
-		if (dist[u][u] > 0){
-			dist[u][u] = 0;
-			prev[u][u] = -1;
+		//every path through a node on a negative cycle is infinitely short
+		if (t == 0) {
+			for (uint k = 0; k < N; ++k)
+				if (P.dist[P.index(k,k)] < 0) negative.push_back(k);
+			reach.resize((std::size_t)negative.size()*N);
 		}
-	}
-	//DP
-	for (uint k = 0; k < N; ++k) {
-		for (uint i = 0; i < N; ++i) {
-			if (dist[i][k] == inf) continue; //optimization
-			for (uint j = 0; j < N; ++j) {
-				if (dist[k][j] == inf) continue;
-				//there is a path between ik and kj, now to check if there is a negative loop there
-				if (dist[k][k] < 0 || dist[k][j] == neginf || dist[i][k] == neginf)
-					dist[i][j] = neginf;
-				else {
-					//if not, check if path ik+kj is smaller than the current path
-					int newDist = dist[i][k] + dist[k][j];
-					if (newDist < dist[i][j]){
-						dist[i][j] = newDist;
-						prev[i][j] = prev[k][j];
-					}
+		barrier.wait();
+		for (uint x = t; x < negative.size(); x += T)
+			for (uint j = 0; j < N; ++j)
+				reach[(std::size_t)x*N + j] = P.dist[P.index(negative[x],j)] != inf;
+		barrier.wait();
+		for (uint i = t; i < N; i += T) {
+			Distance* di = &P.dist[P.index(i,0)];
+			for (uint x = 0; x < negative.size(); ++x) {
+				if (di[negative[x]] == inf) continue;
+				const char* r = &reach[(std::size_t)x*N];
+				for (uint j = 0; j < N; ++j)
+					if (r[j]) di[j] = neginf;
+			}
+		}
+	});
+}
+
+/* @brief: Updates the passed PathMatrix object to contain shortest distance between all pairs of nodes,
+ * exactly like getShortestDistance(PathMatrix&). Faster when the graph is sparse.
+ * @param: P - the result, keeping the predecessors its PathMode asks for
+ * @param: numThreads - number of threads to use, 0 for one per hardware thread
+ * @notes: Implemented using Johnson's algorithm. Bellman-Ford from a virtual source connected to
+ * every node gives potentials h that make all edge weights w(u,v) + h(u) - h(v) nonnegative, then
+ * a Dijkstra search is run from every node in parallel. If there is a negative cycle the
+ * potentials do not exist and Floyd-Warshall is used instead */
+template<typename Weight, typename Node>
+void BasicGraphWD<Weight,Node>::getShortestDistanceSparse(PathMatrix& P, uint numThreads) const {
+	if (frozen) johnson(csr, P, numThreads);
+	else johnson(*this, P, numThreads);
+}
+
+/* @brief: Finds the shortest distances from every node like getShortestDistanceSparse, but hands
+ * each row to f as soon as it is complete instead of keeping the whole matrix. Memory use is one
+ * row per thread, so the distances of graphs far too large for a PathMatrix can be reduced or
+ * written out as they are found
+ * @param: f - called as f(const PathVector& row) once for every source row.getSource(), with the
+ * distances and paths from it. The calls come from the worker threads in no particular order,
+ * but never two at a time, and row is only valid during the call
+ * @param: numThreads - number of threads to use, 0 for one per hardware thread
+ * @notes: Rows are found by Dijkstra searches on Johnson's reweighted edges. If there is a negative
+ * cycle, each row is a getShortestDistance(uint, PathVector&) search instead */
+template<typename Weight, typename Node>
+template<typename RowCallback>
+void BasicGraphWD<Weight,Node>::getShortestDistanceRows(RowCallback f, uint numThreads) const {
+	if (frozen) stream_rows(csr, f, numThreads);
+	else stream_rows(*this, f, numThreads);
+}
+
+template<typename Weight, typename Node>
+template<typename Adj, typename RowCallback>
+void BasicGraphWD<Weight,Node>::stream_rows(const Adj& g, RowCallback& f, uint numThreads) const {
+	vector<Potential> h;
+	bool reweighted = potentials(g, h);
+	std::mutex lock;
+	std::atomic<uint> next(0);
+	runThreads(min(getNumThreads(numThreads), max(1u,N)), [&](uint) {
+		PathVector row;
+		vector<uint> buffer;
+		vector<Potential> dist(reweighted ? N : 0);
+		IndexedHeap<Potential> q(reweighted ? N : 0);
+		for (uint s = next++; s < N; s = next++) {
+			if (reweighted) {
+				row.start(N,s);
+				johnson_row(g, h, s, dist, q, row.dist.data(), row.prev.data());
+			}
+			else
+				bellman_ford(g, s, row, buffer);
+			std::lock_guard<std::mutex> guard(lock);
+			f(static_cast<const PathVector&>(row));
+		}
+	});
+}
+
+/* @return: false if there is a negative cycle, otherwise true with the potentials in h */
+template<typename Weight, typename Node>
+template<typename Adj>
+bool BasicGraphWD<Weight,Node>::potentials(const Adj& g, vector<Potential>& h) const {
+	//the virtual source has an edge of weight 0 to every node
+	h.assign(N,0);
+	bool changed = true;
+	for (uint i = 0; i <= N && changed; ++i) {
+		changed = false;
+		for (uint u = 0; u < N; ++u)
+			for (auto e = g.begin(u); e != g.end(u); ++e)
+				if (h[u] + e->second < h[e->first]) {
+					h[e->first] = h[u] + e->second;
+					changed = true;
 				}
+	}
+	//still improving after N+1 rounds means a negative cycle
+	return !changed;
+}
+
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicGraphWD<Weight,Node>::johnson(const Adj& g, PathMatrix& P, uint numThreads) const {
+	vector<Potential> h;
+	if (!potentials(g, h)) {
+		floyd_warshall(g, P, numThreads);
+		return;
+	}
+	P.resize(N);
+	if (P.predSize == 1) johnson_solve<uint8_t>(g, h, P, numThreads);
+	else if (P.predSize == 2) johnson_solve<uint16_t>(g, h, P, numThreads);
+	else johnson_solve<int>(g, h, P, numThreads);
+}
+
+template<typename Weight, typename Node>
+template<typename Pred, typename Adj>
+void BasicGraphWD<Weight,Node>::johnson_solve(const Adj& g, const vector<Potential>& h, PathMatrix& P, uint numThreads) const {
+	std::atomic<uint> next(0);
+	runThreads(getNumThreads(numThreads), [&](uint) {
+		vector<Potential> dist(N);
+		IndexedHeap<Potential> q(N);
+		for (uint s = next++; s < N; s = next++)
+			johnson_row(g, h, s, dist, q, &P.dist[P.index(s,0)], P.template predecessors<Pred>(s));
+	});
+}
+
+/* @brief: Dijkstra from s on the reweighted edges, writing the distances to ds and the predecessors to ps
+ * @param: dist, q - scratch space for N nodes
+ * @param: ps - N predecessors, all ones for none, or null if they are not wanted */
+template<typename Weight, typename Node>
+template<typename Pred, typename Adj>
+void BasicGraphWD<Weight,Node>::johnson_row(const Adj& g, const vector<Potential>& h, uint s, vector<Potential>& dist,
+		IndexedHeap<Potential>& q, Distance* ds, Pred* ps) const {
+	std::fill(dist.begin(), dist.end(), std::numeric_limits<Potential>::max());
+	if (ps) std::fill(ps, ps + N, (Pred)-1);
+	q.reset(N);
+	dist[s] = 0;
+	q.push(s,0);
+	while (!q.empty()) {
+		uint u = q.top();
+		Potential d = q.topKey();
+		q.pop();
+		for (auto e = g.begin(u); e != g.end(u); ++e) {
+			uint v = e->first;
+			Potential newDist = d + e->second + h[u] - h[v];
+			if (newDist < dist[v]) {
+				dist[v] = newDist;
+				if (ps) ps[v] = u;
+				q.update(v,newDist);
 			}
 		}
 	}
+	//undo the reweighting
+	for (uint v = 0; v < N; ++v)
+		ds[v] = q.settled(v) ? Traits::clamp(dist[v] - h[s] + h[v]) : inf;
+	if (ps) ps[s] = (Pred)-1;
 }
 
+/* Relax the tile of rows [i0,i1) and columns [j0,j1) over the intermediate nodes [k0,k1) */
+template<typename Weight, typename Node>
+template<typename Pred>
+void BasicGraphWD<Weight,Node>::fw_block(PathMatrix& P, uint i0, uint i1, uint j0, uint j1, uint k0, uint k1) {
+	for (uint k = k0; k < k1; ++k) {
+		const Distance* dk = &P.dist[P.index(k,0)];
+		const Pred* pk = P.template predecessors<Pred>(k);
+		for (uint i = i0; i < i1; ++i) {
+			Distance* di = &P.dist[P.index(i,0)];
+			Distance a = di[k];
+			if (a == inf) continue; //optimization
+			//there is a path from i to k, now to check if there is a negative loop there
+			if (dk[k] < 0 || a == neginf) {
+				for (uint j = j0; j < j1; ++j)
+					if (dk[j] != inf) di[j] = neginf;
+			}
+			else if (i != k) //row k can not improve itself when dist[k][k] >= 0
+				fw_relax_row<Pred>(di, P.template predecessors<Pred>(i), dk, pk, a, j0, j1);
+		}
+	}
+}
+
+/* dist[i][j] = min(dist[i][j], dist[i][k] + dist[k][j]) for j = [j0,j1), where a = dist[i][k] is finite.
+ * Without predecessors pi and pk are null. Written without branches so that the compiler can vectorize it */
+template<typename Weight, typename Node>
+template<typename Pred>
+void BasicGraphWD<Weight,Node>::fw_relax_row(Distance* __restrict di, Pred* __restrict pi, const Distance* __restrict dk,
+		const Pred* __restrict pk, Distance a, uint j0, uint j1) {
+	if (!pi) {
+		for (uint j = j0; j < j1; ++j) {
+			Distance b = dk[j];
+			Distance newDist = b == neginf ? neginf : Traits::add(a,b);
+			di[j] = b != inf && newDist < di[j] ? newDist : di[j];
+		}
+		return;
+	}
+	for (uint j = j0; j < j1; ++j) {
+		Distance b = dk[j];
+		Distance newDist = b == neginf ? neginf : Traits::add(a,b);
+		bool better = b != inf && newDist < di[j];
+		pi[j] = better ? pk[j] : pi[j];
+		di[j] = better ? newDist : di[j];
+	}
+}
 
 
 } //namespace graph
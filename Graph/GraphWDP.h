@@ -8,6 +8,9 @@
 #ifndef GRAPHWDP_H_
 #define GRAPHWDP_H_
 #include "GraphWD.h"
+#include "ShortestPathDag.h"
+#include "IndexedHeap.h"
+#include "MonotoneQueue.h"
 
 namespace graph {
 
@@ -15,15 +18,88 @@ namespace graph {
 /*** GraphWDP ***/
 
 /* @brief: Weighted Directed graph with nonnegative edges only
- * May be faster than parent class GraphWD */
-class GraphWDP : public GraphWD {
+ * May be faster than parent class GraphWD. The template parameters are those of BasicGraphWD,
+ * and GraphWDP is BasicGraphWDP<int,uint> */
+template<typename Weight = int, typename Node = uint>
+class BasicGraphWDP : public BasicGraphWD<Weight,Node> {
+	typedef BasicGraphWD<Weight,Node> GraphWD;
 public:
-	GraphWDP(uint n) : GraphWD(n) {}
-	void getShortestDistance(uint u, PathVector& P);
+	typedef typename GraphWD::Traits Traits;
+	typedef typename GraphWD::Distance Distance;
+	typedef typename GraphWD::EdgePair EdgePair;
+	typedef typename GraphWD::EdgeList EdgeList;
+	typedef typename GraphWD::CompactGraph CompactGraph;
+	typedef typename GraphWD::PathVector PathVector;
+	typedef typename GraphWD::SearchWorkspace SearchWorkspace;
+	typedef BasicShortestPathDag<Distance> ShortestPathDag;
+	using GraphWD::inf;
+	using GraphWD::neginf;
+	using GraphWD::begin;
+	using GraphWD::end;
+protected:
+	using GraphWD::N;
+	using GraphWD::edges;
+	using GraphWD::csr;
+	using GraphWD::frozen;
+	using GraphWD::version;
+public:
+	/* Priority queue used by the shortest path searches.
+	 * HEAP - IndexedHeap, works for any weights
+	 * RADIX_HEAP - RadixHeap, near-linear for any nonnegative integer weights
+	 * BUCKET_QUEUE - Dial's BucketQueue, linear when the largest edge weight is small
+	 * AUTO_QUEUE - BUCKET_QUEUE if the largest edge weight is at most N, otherwise RADIX_HEAP
+	 * The monotone queues take 32 bit keys, so HEAP is used whenever the distances are
+	 * floating point or wider than 32 bits, see WeightTraits::smallKeys */
+	enum QueueType { HEAP, RADIX_HEAP, BUCKET_QUEUE, AUTO_QUEUE };
+	BasicGraphWDP(uint n) : GraphWD(n), reverseVersion(0) {}
+	using GraphWD::addEdge;
+	void addEdge(uint u, uint v, Weight w, PathVector& P);
+	using GraphWD::removeEdge;
+	bool removeEdge(uint u, uint v, Weight w, PathVector& P);
+	/* Hides GraphWD::getShortestDistance(uint, PathVector&), so const graphs also search with UCS */
+	void getShortestDistance(uint s, PathVector& P) const {getShortestDistance(s,P,HEAP);}
+	void getShortestDistance(uint s, PathVector& P, QueueType type) const;
+	void getShortestDistance(uint s, SearchWorkspace& W) const;
 	using GraphWD::getShortestDistance;
-	GraphWDP getShortestDistanceMulti(uint s);
+	void getShortestDistanceMulti(uint s, ShortestPathDag& D, QueueType type = HEAP) const;
+	void getShortestDistanceBatch(const vector<uint>& sources, vector<PathVector>& P,
+			QueueType type = HEAP, uint numThreads = 0) const;
+	void getShortestDistanceTable(const vector<uint>& sources, const vector<uint>& targets,
+			vector<Distance>& table, QueueType type = HEAP, uint numThreads = 0) const;
+	template<typename OutIter>
+	Distance getShortestPath(uint s, uint t, OutIter out);
+protected:
+	CompactGraph rev; /* reverse edges for backward searches, built on demand */
+	uint64_t reverseVersion; /* version of the edges rev was built from, 0 if it is not built */
+	void update_reverse();
+	template<typename Adj>
+	QueueType choose_queue(const Adj& g, QueueType type, uint& maxWeight) const;
+	template<typename Adj>
+	void ucs_select(const Adj& g, uint s, PathVector& result, QueueType type) const;
+	template<typename Adj, typename Queue, typename Labels>
+	void ucs(const Adj& g, uint s, Labels& result, Queue& q) const;
+	template<typename Adj>
+	void ucs_batch_select(const Adj& g, const vector<uint>& sources, PathVector* P,
+			const vector<uint>* targets, Distance* table, QueueType type, uint numThreads) const;
+	template<typename Adj, typename Queue>
+	void ucs_batch(const Adj& g, const vector<uint>& sources, PathVector* P,
+			const vector<uint>* targets, Distance* table, const Queue& empty, uint numThreads) const;
+	template<typename Adj>
+	void ucs_multi_select(const Adj& g, uint s, ShortestPathDag& D, QueueType type) const;
+	template<typename Adj, typename Queue>
+	void ucs_multi(const Adj& g, uint s, ShortestPathDag& D, Queue& q) const;
+	/* The two sides of the bidirectional search, kept so that a query only touches what it visits */
+	SearchWorkspace fwd, bwd;
+	/* Queue and marks of the repairs of addEdge and removeEdge with a PathVector */
+	SearchWorkspace repair;
+	template<typename Adj, typename OutIter>
+	Distance bidirectional(const Adj& g, uint s, uint t, OutIter out);
+	template<typename Adj>
+	static void bidirectional_scan(const Adj& g, SearchWorkspace& side, const SearchWorkspace& other, Distance& best, int& meet);
 };
 
+typedef BasicGraphWDP<> GraphWDP;
+
 
 
 
@@ -31,79 +107,368 @@ public:
  * If no path exists, the distance is graph::inf.
  * @param: s - source node
  * @param: P - Path object to contain the result
+ * @param: type - the priority queue to use, see QueueType
  * @notes: Implemented using UCS (Uniform Cost Search) */
-void GraphWDP::getShortestDistance(uint s, PathVector& result){
-	typedef pair<uint,int> d_pair;
+template<typename Weight, typename Node>
+void BasicGraphWDP<Weight,Node>::getShortestDistance(uint s, PathVector& result, QueueType type) const {
+	if (frozen) ucs_select(csr, s, result, type);
+	else ucs_select(*this, s, result, type);
+}
+
+/* Resolves AUTO_QUEUE and finds the largest edge weight if a BucketQueue is used */
+template<typename Weight, typename Node>
+template<typename Adj>
+typename BasicGraphWDP<Weight,Node>::QueueType BasicGraphWDP<Weight,Node>::choose_queue(const Adj& g, QueueType type, uint& maxWeight) const {
+	maxWeight = 0;
+	if (!Traits::smallKeys) return HEAP;
+	if (type != BUCKET_QUEUE && type != AUTO_QUEUE) return type;
+	for (uint u = 0; u < N; ++u)
+		for (auto edge = g.begin(u); edge != g.end(u); ++edge)
+			maxWeight = max(maxWeight,(uint)edge->second);
+	if (type == AUTO_QUEUE)
+		type = maxWeight <= N ? BUCKET_QUEUE : RADIX_HEAP;
+	return type;
+}
+
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicGraphWDP<Weight,Node>::ucs_select(const Adj& g, uint s, PathVector& result, QueueType type) const {
+	uint maxWeight;
+	type = choose_queue(g,type,maxWeight);
+	if (type == RADIX_HEAP) {RadixHeap q(N); ucs(g,s,result,q);}
+	else if (type == BUCKET_QUEUE) {BucketQueue q(N,maxWeight); ucs(g,s,result,q);}
+	else {IndexedHeap<Distance> q(N); ucs(g,s,result,q);}
+}
+
+template<typename Weight, typename Node>
+template<typename Adj, typename Queue, typename Labels>
+void BasicGraphWDP<Weight,Node>::ucs(const Adj& g, uint s, Labels& result, Queue& q) const {
 	uint u,v;
-	int d;
-	int w;
-	result.u = s;
-	auto& dist = result.dist;
-	auto& prev = result.prev;
-	auto comp = [](pair<uint,int> a, pair<uint,int> b) {
-		return a.second > b.second;
-	};
-	dist.assign(N,inf);
-	prev.assign(N,-1);
-	priority_queue<d_pair,vector<d_pair>,decltype(comp)> q(comp);
-	dist[s] = 0;
-	q.push({s,dist[s]});
+	Distance d;
+	result.start(N,s);
+	//each node is in the queue at most once, improvements are done with decrease-key
+	result.set(s,0,-1);
+	q.push(s,0);
 	while(!q.empty()){
-		u = q.top().first;
-		d = q.top().second;
+		u = q.top();
+		d = q.topKey();
 		q.pop();
-		for (auto edge = begin(u); edge != end(u); ++edge){
+		for (auto edge = g.begin(u); edge != g.end(u); ++edge){
 			v = edge->first;
-			w = edge->second;
-			int newDist = d + w;
+			Distance newDist = Traits::add(d, edge->second);
 			// if better, replace
-			if (newDist < dist[v]){
-				dist[v] = newDist;
-				q.push({v,newDist});
-				prev[v] = u;
+			if (newDist < result.distance(v)){
+				result.set(v,newDist,u);
+				q.update(v,newDist);
 			}
 		}
 	}
 }
 
-/* Returns a graph of all shortest paths from node s to all other nodes
+/* @brief: Like getShortestDistance(uint, PathVector&, QueueType), but the result is kept in a
+ * SearchWorkspace so that the search takes time proportional to the number of nodes and edges
+ * reachable from s
  * @param: s - source node
- * @param: P - Path object to contain the result
- * @notes: Implemented using UCS (Uniform Cost Search) */
-GraphWDP GraphWDP::getShortestDistanceMulti(uint s) {
-	typedef pair<uint,int> d_pair;
+ * @param: W - workspace to contain the result, reusable for any number of searches
+ * @notes: Uses the IndexedHeap of the workspace, whose reset is sparse as well */
+template<typename Weight, typename Node>
+void BasicGraphWDP<Weight,Node>::getShortestDistance(uint s, SearchWorkspace& W) const {
+	if (frozen) ucs(csr, s, W, W.q);
+	else ucs(*this, s, W, W.q);
+}
+
+/* @brief: Runs getShortestDistance(uint, PathVector&, QueueType) from each of the sources, spread
+ * over a number of threads that each reuse their own priority queue
+ * @param: sources - source nodes
+ * @param: P - receives the result for sources[i] in P[i]. It is resized to the number of sources,
+ * and the PathVectors already in it are reused without reallocating
+ * @param: type - the priority queue to use, see QueueType
+ * @param: numThreads - number of threads to use, 0 for one per hardware thread */
+template<typename Weight, typename Node>
+void BasicGraphWDP<Weight,Node>::getShortestDistanceBatch(const vector<uint>& sources, vector<PathVector>& P,
+		QueueType type, uint numThreads) const {
+	P.resize(sources.size());
+	if (frozen) ucs_batch_select(csr, sources, P.data(), 0, 0, type, numThreads);
+	else ucs_batch_select(*this, sources, P.data(), 0, 0, type, numThreads);
+}
+
+/* @brief: Finds the shortest distance from each of the sources to each of the targets, spread
+ * over a number of threads like getShortestDistanceBatch
+ * @param: sources - source nodes
+ * @param: targets - target nodes
+ * @param: table - receives the distance from sources[i] to targets[j] in table[i*targets.size() + j],
+ * graph::inf if there is no path
+ * @param: type - the priority queue to use, see QueueType
+ * @param: numThreads - number of threads to use, 0 for one per hardware thread */
+template<typename Weight, typename Node>
+void BasicGraphWDP<Weight,Node>::getShortestDistanceTable(const vector<uint>& sources, const vector<uint>& targets,
+		vector<Distance>& table, QueueType type, uint numThreads) const {
+	table.resize(sources.size() * targets.size());
+	if (frozen) ucs_batch_select(csr, sources, 0, &targets, table.data(), type, numThreads);
+	else ucs_batch_select(*this, sources, 0, &targets, table.data(), type, numThreads);
+}
+
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicGraphWDP<Weight,Node>::ucs_batch_select(const Adj& g, const vector<uint>& sources, PathVector* P,
+		const vector<uint>* targets, Distance* table, QueueType type, uint numThreads) const {
+	uint maxWeight;
+	type = choose_queue(g,type,maxWeight);
+	if (type == RADIX_HEAP) ucs_batch(g, sources, P, targets, table, RadixHeap(N), numThreads);
+	else if (type == BUCKET_QUEUE) ucs_batch(g, sources, P, targets, table, BucketQueue(N,maxWeight), numThreads);
+	else ucs_batch(g, sources, P, targets, table, IndexedHeap<Distance>(N), numThreads);
+}
+
+/* Writes the result for sources[i] to P[i] if P is given, otherwise the distances to the targets to row i of table.
+ * Each thread resets its copy of the empty queue before every search */
+template<typename Weight, typename Node>
+template<typename Adj, typename Queue>
+void BasicGraphWDP<Weight,Node>::ucs_batch(const Adj& g, const vector<uint>& sources, PathVector* P,
+		const vector<uint>* targets, Distance* table, const Queue& empty, uint numThreads) const {
+	uint T = min<size_t>(getNumThreads(numThreads), max<size_t>(1, sources.size()));
+	vector<Queue> queue(T, empty);
+	vector<PathVector> result(P ? 0 : T);
+	runTasks(sources.size(), T, [&](uint i, uint t) {
+		PathVector& res = P ? P[i] : result[t];
+		queue[t] = empty;
+		ucs(g, sources[i], res, queue[t]);
+		if (table)
+			for (size_t j = 0; j < targets->size(); ++j)
+				table[i*targets->size() + j] = res.dist[(*targets)[j]];
+	});
+}
+
+/* @brief: Finds all shortest paths from node s to all other nodes, as the predecessors of
+ * every node on its shortest paths, and the path counts and dependencies D is set up to compute,
+ * see ShortestPathDag::CountMode. Everything is computed in one search, and the buffers of D and
+ * the priority queue it keeps are reused, so repeated calls on the same graph, e.g. one per source
+ * for betweenness centrality, do not allocate once D has grown to fit
+ * @param: s - source node
+ * @param: D - receives the shortest path DAG
+ * @param: type - the priority queue to use, see QueueType
+ * @notes: Implemented using UCS (Uniform Cost Search). A tie found through an edge of weight 0
+ * after its target is settled is left out, which keeps the result acyclic and the counts
+ * consistent with it even where such edges form cycles */
+template<typename Weight, typename Node>
+void BasicGraphWDP<Weight,Node>::getShortestDistanceMulti(uint s, ShortestPathDag& D, QueueType type) const {
+	if (frozen) ucs_multi_select(csr, s, D, type);
+	else ucs_multi_select(*this, s, D, type);
+}
+
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicGraphWDP<Weight,Node>::ucs_multi_select(const Adj& g, uint s, ShortestPathDag& D, QueueType type) const {
+	uint maxWeight;
+	type = choose_queue(g,type,maxWeight);
+	if (type == RADIX_HEAP) {D.radix.reset(N); ucs_multi(g,s,D,D.radix);}
+	else if (type == BUCKET_QUEUE) {D.bucket.reset(N,maxWeight); ucs_multi(g,s,D,D.bucket);}
+	else {D.heap.reset(N); ucs_multi(g,s,D,D.heap);}
+}
+
+template<typename Weight, typename Node>
+template<typename Adj, typename Queue>
+void BasicGraphWDP<Weight,Node>::ucs_multi(const Adj& g, uint s, ShortestPathDag& D, Queue& q) const {
 	uint u,v;
-	int d,w;
-	std::vector<uint> dist(N,inf);
-	GraphWDP res(N);
-	auto comp = [](pair<uint,int> a, pair<uint,int> b) {
-		return a.second > b.second;
-	};
-	priority_queue<d_pair,vector<d_pair>,decltype(comp)> q(comp);
-	dist[s] = 0;
-	q.push({s,dist[s]});
+	Distance d;
+	D.start(N,s);
+	auto& dist = D.dist;
+	q.push(s,dist[s]);
 	while(!q.empty()){
-		u = q.top().first;
-		d = q.top().second;
+		u = q.top();
+		d = q.topKey();
 		q.pop();
-		for (auto edge = begin(u); edge != end(u); ++edge){
+		D.settle(u);
+		for (auto edge = g.begin(u); edge != g.end(u); ++edge){
 			v = edge->first;
-			w = edge->second;
-			int newDist = d + w;
+			Distance newDist = Traits::add(d, edge->second);
 			// if better, replace
 			if (newDist < dist[v]) {
-				dist[v] = newDist;
-				q.push({v,newDist});
-				res.edges[v].clear();
-				res.edges[v].push_back({u,w});
-			} else if (newDist == dist[v]) {
-				res.edges[v].push_back({u,w});
+				D.improve(v,newDist,u);
+				q.update(v,newDist);
+			} else if (newDist == dist[v] && newDist != inf && !D.closed[v]) {
+				D.tie(v,u);
+			}
+		}
+	}
+	D.finish();
+}
+
+/* @brief: Adds an edge from u to v with weight w, like addEdge(uint, uint, int), and repairs P,
+ * which must hold the shortest paths from some source before the edge was added.
+ * Adding an edge that is cheaper than an existing one is how a weight is decreased
+ * @param: P - result of getShortestDistance, updated to the graph with the new edge
+ * @notes: Only the nodes whose distance gets shorter are searched, starting from v with
+ * a Dijkstra search that stops expanding as soon as distances no longer improve */
+template<typename Weight, typename Node>
+void BasicGraphWDP<Weight,Node>::addEdge(uint u, uint v, Weight w, PathVector& P) {
+	addEdge(u,v,w);
+	auto& dist = P.dist;
+	auto& prev = P.prev;
+	if (dist[u] == inf || Traits::add(dist[u], w) >= dist[v]) return;
+	auto& q = repair.q;
+	repair.start(N,v);
+	dist[v] = Traits::add(dist[u], w);
+	prev[v] = u;
+	repair.set(v,dist[v],u);
+	q.push(v,dist[v]);
+	while (!q.empty()) {
+		uint x = q.top();
+		q.pop();
+		for (auto edge = begin(x); edge != end(x); ++edge) {
+			Distance newDist = Traits::add(dist[x], edge->second);
+			if (newDist < dist[edge->first]) {
+				dist[edge->first] = newDist;
+				prev[edge->first] = x;
+				repair.set(edge->first,newDist,x);
+				q.update(edge->first,newDist);
+			}
+		}
+	}
+}
+
+/* @brief: Removes one edge from u to v with weight w, like removeEdge(uint, uint, int), and
+ * repairs P, which must hold the shortest paths from some source before the edge was removed.
+ * Removing an edge and adding it back with a larger weight is how a weight is increased
+ * @param: P - result of getShortestDistance, updated to the graph without the edge
+ * @return: false if there is no such edge, and P is left as it is
+ * @notes: Only the nodes below v in the shortest path tree can get longer paths, if the edge
+ * is in the tree. They are reset and get new distances from a Dijkstra search among them,
+ * seeded by their edges from the rest of the graph, which are found through the reverse edges,
+ * so the cost is proportional to the edges of the subtree. The removal keeps the reverse edges
+ * up to date, so only edges added since they were last built cause them to be rebuilt */
+template<typename Weight, typename Node>
+bool BasicGraphWDP<Weight,Node>::removeEdge(uint u, uint v, Weight w, PathVector& P) {
+	update_reverse();
+	if (!removeEdge(u,v,w)) return false;
+	rev.makeLoop(v,u,w);
+	reverseVersion = version;
+	auto& dist = P.dist;
+	auto& prev = P.prev;
+	if (prev[v] != (int)u || dist[u] == inf || Traits::add(dist[u], w) != dist[v]) return true; //not a tree edge
+	//collect the subtree of v by following tree edges, marking it as reached by the repair
+	const vector<uint>& subtree = repair.touched;
+	repair.start(N,v);
+	repair.set(v,inf,-1);
+	for (uint i = 0; i < subtree.size(); ++i) {
+		uint x = subtree[i];
+		for (auto edge = begin(x); edge != end(x); ++edge)
+			if (prev[edge->first] == (int)x && !repair.reached(edge->first))
+				repair.set(edge->first,inf,-1);
+	}
+	for (uint x : subtree) {
+		dist[x] = inf;
+		prev[x] = -1;
+	}
+	//the rest of the tree is unchanged, its edges into the subtree are where the new paths enter
+	auto& q = repair.q;
+	for (uint x : subtree) {
+		for (auto edge = rev.begin(x); edge != rev.end(x); ++edge) {
+			uint y = edge->first;
+			if (repair.reached(y) || dist[y] == inf) continue;
+			Distance newDist = Traits::add(dist[y], edge->second);
+			if (newDist < dist[x]) {
+				dist[x] = newDist;
+				prev[x] = y;
+			}
+		}
+		if (dist[x] != inf)
+			q.push(x,dist[x]);
+	}
+	while (!q.empty()) {
+		uint x = q.top();
+		q.pop();
+		for (auto edge = begin(x); edge != end(x); ++edge) {
+			Distance newDist = Traits::add(dist[x], edge->second);
+			if (repair.reached(edge->first) && newDist < dist[edge->first]) {
+				dist[edge->first] = newDist;
+				prev[edge->first] = x;
+				q.update(edge->first,newDist);
 			}
 		}
 	}
-	return res;
+	return true;
 }
 
+/* Rebuild the reverse edges if the edges have changed since they were last built */
+template<typename Weight, typename Node>
+void BasicGraphWDP<Weight,Node>::update_reverse() {
+	if (reverseVersion == version) return;
+	if (frozen) rev.assignReverse(N, csr);
+	else rev.assignReverse(N, *this);
+	reverseVersion = version;
+}
+
+/* @brief: Finds a shortest path from s to t. Writes the nodes of the path to out starting
+ * from t and ending at s (inclusive), or nothing if there is no path.
+ * @param: s - source node
+ * @param: t - target node
+ * @param: out - output iterator to which the path is written
+ * @return: The length of the path, or graph::inf if there is no path
+ * @notes: Implemented using bidirectional Dijkstra. The search stops when the two
+ * frontiers meet, so usually only a small part of the graph is explored, and the state of
+ * both sides is kept between calls like a SearchWorkspace, so a query costs time proportional
+ * to what it explores. The reverse edges are built on the first call after edges have been added */
+template<typename Weight, typename Node>
+template<typename OutIter>
+typename BasicGraphWDP<Weight,Node>::Distance BasicGraphWDP<Weight,Node>::getShortestPath(uint s, uint t, OutIter out) {
+	update_reverse();
+	if (frozen) return bidirectional(csr, s, t, out);
+	return bidirectional(*this, s, t, out);
+}
+
+template<typename Weight, typename Node>
+template<typename Adj, typename OutIter>
+typename BasicGraphWDP<Weight,Node>::Distance BasicGraphWDP<Weight,Node>::bidirectional(const Adj& g, uint s, uint t, OutIter out) {
+	Distance best = inf;
+	int meet = -1;
+	fwd.start(N,s); fwd.set(s,0,-1); fwd.q.push(s,0);
+	bwd.start(N,t); bwd.set(t,0,-1); bwd.q.push(t,0);
+	if (s == t) {best = 0; meet = s;}
+	while (!fwd.q.empty() && !bwd.q.empty()) {
+		//no path through unsettled nodes can be shorter than the best one found
+		if (Traits::add(fwd.q.topKey(), bwd.q.topKey()) >= best) break;
+		if (fwd.q.topKey() <= bwd.q.topKey())
+			bidirectional_scan(g, fwd, bwd, best, meet);
+		else
+			bidirectional_scan(rev, bwd, fwd, best, meet);
+	}
+	if (meet == -1) return inf;
+	//the part meet -> t is stored as successors, reverse it to write t first
+	vector<uint> tail;
+	for (int v = meet; v != (int)t; v = bwd.previous(v))
+		tail.push_back(bwd.previous(v));
+	for (auto it = tail.rbegin(); it != tail.rend(); ++it) {
+		*out = *it; ++out;
+	}
+	for (int v = meet; v != -1; v = fwd.previous(v)) {
+		*out = v; ++out;
+	}
+	return best;
+}
+
+/* Settle the closest node of one side and relax its edges, recording the best meeting point */
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicGraphWDP<Weight,Node>::bidirectional_scan(const Adj& g, SearchWorkspace& side, const SearchWorkspace& other, Distance& best, int& meet) {
+	uint u = side.q.top();
+	side.q.pop();
+	Distance d = side.distance(u);
+	for (auto edge = g.begin(u); edge != g.end(u); ++edge) {
+		uint v = edge->first;
+		Distance newDist = Traits::add(d, edge->second);
+		Distance dv = side.distance(v);
+		if (newDist < dv) {
+			dv = newDist;
+			side.set(v,dv,u);
+			side.q.update(v,dv);
+		}
+		Distance dw = other.distance(v);
+		if (dw != inf && dv != inf && Traits::add(dv, dw) < best) {
+			best = Traits::add(dv, dw);
+			meet = v;
+		}
+	}
+}
 
 } //namespace graph
 
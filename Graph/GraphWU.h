@@ -8,7 +8,13 @@
 #ifndef GRAPHWU_H_
 #define GRAPHWU_H_
 #include "GraphUtil.h"
+#include "CompactGraph.h"
+#include "NodeOrder.h"
+#include "IndexedHeap.h"
+#include "DisjointSets.h"
+#include "Parallel.h"
 #include "Tree.h"
+#include <atomic>
 
 namespace graph {
 
@@ -16,81 +22,334 @@ namespace graph {
 
 /*** GraphWU ***/
 
-/* @brief: Weighted Undirected Graph allowing positive and negative edge weights */
-class GraphWU {
+/* @brief: Weighted Undirected Graph allowing positive and negative edge weights
+ * @param: Weight - the type of the edge weights, the weight of a tree is of type WeightTraits<Weight>::Distance
+ * @param: Node - the type in which the destination of each edge is stored, unsigned and at most as wide as uint,
+ * and with room for every node, which is asserted. The Tree stores nodes in NodeTraits<Node>::Index
+ * @notes: GraphWU is BasicGraphWU<int,uint> */
+template<typename Weight = int, typename Node = uint>
+class BasicGraphWU {
+	static_assert(NodeTraits<Node>::valid, "Node must be unsigned and at most as wide as uint");
 public:
-	typedef pair<uint,int> EdgePair; // first: destination node  second: edge weight
+	typedef WeightTraits<Weight> Traits;
+	typedef typename Traits::Distance Distance;
+	typedef pair<Node,Weight> EdgePair; // first: destination node  second: edge weight
 	typedef vector<EdgePair> EdgeList;
+	typedef BasicCompactGraph<Weight,Node> CompactGraph;
+	typedef BasicTree<Distance, typename NodeTraits<Node>::Index> Tree;
+	static constexpr Distance inf = Traits::inf();
+	/* Algorithm used by getMinimumSpanningForest
+	 * KRUSKAL - sorts all edges in parallel, then adds them in order unless they close a cycle
+	 * BORUVKA - repeatedly adds the lightest edge leaving every tree, scanning the edges in parallel */
+	enum ForestAlgorithm { KRUSKAL, BORUVKA };
 protected:
+	/* An edge of the flat edge list used by the forest algorithms, u < v */
+	struct Edge {
+		Weight w;
+		uint u, v;
+	};
 	uint N;
 	vector<EdgeList> edges;
+	CompactGraph csr; /* holds the edges instead of 'edges' while frozen */
+	bool frozen;
 public:
-	GraphWU(uint n) : N(n), edges(n) {}
+	BasicGraphWU(uint n) : N(n), edges(n), frozen(false) {assert(NodeTraits<Node>::holds(n));}
 	void reset(uint n);
-	/* Add edge from u to v with weight w */
-	void addEdge(uint u, uint v, int w) { edges[u].push_back({v,w}); edges[v].push_back({u,w}); }
-	/* @return: Begin Iterator for edges going from node u */
-	EdgeList::const_iterator begin(uint u) const {return edges[u].begin();}
-	/* @return: Beyond-end Iterator for edges going from node u */
-	EdgeList::const_iterator end(uint u) const {return edges[u].end();}
+	/* @return: Number of nodes */
+	uint size() const {return N;}
+	/* Add edge from u to v with weight w. The graph must not be frozen */
+	void addEdge(uint u, uint v, Weight w) { edges[u].push_back(EdgePair(v,w)); edges[v].push_back(EdgePair(u,w)); }
+	/* @return: Begin Iterator for edges going from node u. Use getCompact() while frozen */
+	typename EdgeList::const_iterator begin(uint u) const {return edges[u].begin();}
+	/* @return: Beyond-end Iterator for edges going from node u. Use getCompact() while frozen */
+	typename EdgeList::const_iterator end(uint u) const {return edges[u].end();}
+	void freeze();
+	void thaw();
+	void permute(const NodeOrder& P);
+	bool isFrozen() const {return frozen;}
+	/* @return: The packed edges, only valid while frozen */
+	const CompactGraph& getCompact() const {return csr;}
+	void setCompact(CompactGraph g);
 	void getMinimumSpanningTree(Tree& T) const;
+	void getMinimumSpanningForest(Tree& T, ForestAlgorithm alg = BORUVKA, uint numThreads = 0) const;
+protected:
+	template<typename Adj>
+	void prim(const Adj& g, Tree& T) const;
+	template<typename Adj>
+	void collect_edges(const Adj& g, vector<Edge>& E, uint numThreads) const;
+	void kruskal(vector<Edge>& E, vector<uint>& chosen, uint numThreads) const;
+	void boruvka(const vector<Edge>& E, vector<uint>& chosen, uint numThreads) const;
+	void make_forest(const vector<Edge>& E, const vector<uint>& chosen, Tree& T) const;
 };
 
+typedef BasicGraphWU<> GraphWU;
+
+
+template<typename Weight, typename Node>
+constexpr typename BasicGraphWU<Weight,Node>::Distance BasicGraphWU<Weight,Node>::inf;
+
 
 
 
 /* Reset a Graph to another size to save unnecessary reallocation ;) */
-void GraphWU::reset(uint n){
+template<typename Weight, typename Node>
+void BasicGraphWU<Weight,Node>::reset(uint n){
+	assert(NodeTraits<Node>::holds(n));
+	if (frozen) {csr.clear(); frozen = false;}
 	N = n;
 	edges.resize(n);
 	for (uint i = 0; i < n; ++i)
 		edges[i].clear();
 }
 
+/* @brief: Packs all edges into contiguous arrays (see CompactGraph) and releases the
+ * per-node edge lists. Call thaw() before adding more edges */
+template<typename Weight, typename Node>
+void BasicGraphWU<Weight,Node>::freeze() {
+	if (frozen) return;
+	csr.assign(edges);
+	vector<EdgeList>().swap(edges);
+	frozen = true;
+}
+
+/* @brief: Replaces the graph by the packed edges g, leaving it frozen with g.size() nodes.
+ * If g is a view, e.g. of a mapped file (see GraphFile), the edges are not copied
+ * and the graph only reads from the memory of the view */
+template<typename Weight, typename Node>
+void BasicGraphWU<Weight,Node>::setCompact(CompactGraph g) {
+	assert(NodeTraits<Node>::holds(g.size()));
+	vector<EdgeList>().swap(edges);
+	N = g.size();
+	csr = std::move(g);
+	frozen = true;
+}
+
+/* @brief: Renumbers every node v to P.newId(v), keeping the order of the edges of each node.
+ * A frozen graph stays frozen, with its packed edges rebuilt
+ * @param: P - an order of the nodes of this graph, see NodeOrder */
+template<typename Weight, typename Node>
+void BasicGraphWU<Weight,Node>::permute(const NodeOrder& P) {
+	if (frozen) {csr.permute(P.getPermutation()); return;}
+	vector<EdgeList> e(N);
+	for (uint u = 0; u < N; ++u) {
+		EdgeList& l = e[P.newId(u)];
+		l.swap(edges[u]);
+		for (auto& x : l)
+			x.first = P.newId(x.first);
+	}
+	edges.swap(e);
+}
+
+/* @brief: Moves the packed edges back into per-node edge lists so that edges can be added again */
+template<typename Weight, typename Node>
+void BasicGraphWU<Weight,Node>::thaw() {
+	if (!frozen) return;
+	csr.unpack(edges);
+	csr.clear();
+	frozen = false;
+}
+
 /* @brief: Updates Tree object to contain a minimum spanning tree of the graph
  * @param: T - Tree object to store the tree in
  * @notes: Implemented using Prim's algorithm */
-void GraphWU::getMinimumSpanningTree(Tree& T) const {
-	typedef pair<uint,int> d_pair;
+template<typename Weight, typename Node>
+void BasicGraphWU<Weight,Node>::getMinimumSpanningTree(Tree& T) const {
+	if (frozen) prim(csr, T);
+	else prim(*this, T);
+}
+
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicGraphWU<Weight,Node>::prim(const Adj& g, Tree& T) const {
 	T.N = N;
 	uint u,v,root=N-1;
-	int w;
+	Distance w;
 	auto& prev = T.prev;
 	prev.assign(N,-1);
-	vector<int> dist(N,inf);
-	auto comp = [](d_pair a, d_pair b) {
-		return a.second > b.second;
-	};
-	//priority queue for finding nearest uncolored node
-	priority_queue<d_pair,vector<d_pair>,decltype(comp)> q(comp);
-	vector<bool> colored(N,false);
+	vector<Distance> dist(N,inf);
+	//heap for finding nearest uncolored node, a node is colored once it has been popped
+	IndexedHeap<Distance> q(N);
 	dist[root]=0;
-	q.push({root,dist[root]});
+	q.push(root,dist[root]);
 	while (!q.empty()){
-		//pick nearest node that is uncolored
-		u = q.top().first;
+		//pick nearest node that is uncolored and color it
+		u = q.top();
 		q.pop();
-		if (colored[u]) continue;
-		colored[u] = true; //color it
 		// update uncolored neighbors
-		for (auto edge = begin(u); edge != end(u); ++edge){
+		for (auto edge = g.begin(u); edge != g.end(u); ++edge){
 			v = edge->first;
 			w = edge->second;
-			if (colored[v]) continue;
+			if (q.settled(v)) continue;
 			if (w < dist[v]){
 				dist[v] = w;
 				prev[v] = u;
-				q.push({v,w});
+				q.update(v,w);
 			}
 		}
 	}
 	//get total weight of tree. If some weight is inf, no path was found
-	int sum = 0;
+	Distance sum = 0;
 	for (uint i = 0; i < N; ++i){
-		if (dist[i] == inf) {T.w = inf; return;}
-		sum += dist[i];
+		if (dist[i] == inf) {T.w = inf; T.numTrees = 0; return;}
+		sum = Traits::add(sum, dist[i]);
 	}
 	T.w = sum;
+	T.numTrees = 1;
+}
+
+/* @brief: Updates Tree object to contain a minimum spanning forest of the graph, i.e. a
+ * minimum spanning tree of every connected component. On a connected graph this is a
+ * minimum spanning tree rooted at n-1, like getMinimumSpanningTree gives
+ * @param: T - Tree object to store the forest in
+ * @param: alg - KRUSKAL or BORUVKA
+ * @param: numThreads - number of threads to use, 0 for one per hardware thread
+ * @notes: Both algorithms work on a flat list of the edges. Boruvka needs O(log n) passes
+ * over the remaining edges, which spread evenly over the threads, while only the sort of
+ * Kruskal is parallel */
+template<typename Weight, typename Node>
+void BasicGraphWU<Weight,Node>::getMinimumSpanningForest(Tree& T, ForestAlgorithm alg, uint numThreads) const {
+	vector<Edge> E;
+	vector<uint> chosen;
+	if (frozen) collect_edges(csr, E, numThreads);
+	else collect_edges(*this, E, numThreads);
+	if (alg == KRUSKAL) kruskal(E, chosen, numThreads);
+	else boruvka(E, chosen, numThreads);
+	make_forest(E, chosen, T);
+}
+
+/* Lists every edge once, as u < v, ordered by u. Self loops are left out */
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicGraphWU<Weight,Node>::collect_edges(const Adj& g, vector<Edge>& E, uint numThreads) const {
+	uint T = getNumThreads(numThreads);
+	vector<size_t> count(T+1,0);
+	Barrier barrier(T);
+	runThreads(T, [&](uint t) {
+		uint lo = (unsigned long long)N*t/T, hi = (unsigned long long)N*(t+1)/T;
+		size_t c = 0;
+		for (uint u = lo; u < hi; ++u)
+			for (auto e = g.begin(u); e != g.end(u); ++e)
+				c += u < e->first;
+		count[t+1] = c;
+		barrier.wait();
+		if (t == 0) {
+			for (uint i = 0; i < T; ++i)
+				count[i+1] += count[i];
+			E.resize(count[T]);
+		}
+		barrier.wait();
+		size_t i = count[t];
+		for (uint u = lo; u < hi; ++u)
+			for (auto e = g.begin(u); e != g.end(u); ++e)
+				if (u < e->first) E[i++] = {e->second, u, (uint)e->first};
+	});
+}
+
+/* Sorts E by weight and writes the indices of the forest edges to chosen */
+template<typename Weight, typename Node>
+void BasicGraphWU<Weight,Node>::kruskal(vector<Edge>& E, vector<uint>& chosen, uint numThreads) const {
+	parallelSort(E.begin(), E.end(), [](const Edge& a, const Edge& b) {return a.w < b.w;}, numThreads);
+	DisjointSets sets(N);
+	for (uint i = 0; i < E.size() && chosen.size() + 1 < N; ++i)
+		if (sets.join(E[i].u, E[i].v))
+			chosen.push_back(i);
+}
+
+/* Writes the indices in E of the forest edges to chosen */
+template<typename Weight, typename Node>
+void BasicGraphWU<Weight,Node>::boruvka(const vector<Edge>& E, vector<uint>& chosen, uint numThreads) const {
+	const uint none = ~0u;
+	uint T = getNumThreads(numThreads);
+	DisjointSets sets(N);
+	vector<uint> comp(N); /* representative of each node's tree, updated after every round */
+	vector<std::atomic<uint> > best(N); /* index of the lightest edge leaving each tree */
+	//ties are broken by index, so that every tree agrees on the order of the edges and no cycle is chosen
+	auto lighter = [&](uint i, uint j) {return j == none || E[i].w < E[j].w || (E[i].w == E[j].w && i < j);};
+	vector<vector<uint> > live(T); /* edges each thread still has to look at */
+	Barrier barrier(T);
+	bool merged = false;
+	runThreads(T, [&](uint t) {
+		uint lo = (unsigned long long)N*t/T, hi = (unsigned long long)N*(t+1)/T;
+		vector<uint>& mine = live[t];
+		for (uint i = E.size()*t/T; i < E.size()*(t+1)/T; ++i)
+			mine.push_back(i);
+		for (uint u = lo; u < hi; ++u)
+			comp[u] = u;
+		while (true) {
+			for (uint u = lo; u < hi; ++u)
+				best[u].store(none, std::memory_order_relaxed);
+			barrier.wait();
+			//the edges between different trees offer themselves to both trees, the rest are dropped
+			uint kept = 0;
+			for (uint i : mine) {
+				uint cu = comp[E[i].u], cv = comp[E[i].v];
+				if (cu == cv) continue;
+				mine[kept++] = i;
+				for (uint c : {cu, cv}) {
+					uint old = best[c].load(std::memory_order_relaxed);
+					while (lighter(i, old) && !best[c].compare_exchange_weak(old, i));
+				}
+			}
+			mine.resize(kept);
+			barrier.wait();
+			if (t == 0) {
+				merged = false;
+				for (uint c = 0; c < N; ++c) {
+					uint i = best[c].load(std::memory_order_relaxed);
+					if (i == none) continue;
+					if (sets.join(E[i].u, E[i].v)) {
+						chosen.push_back(i);
+						merged = true;
+					}
+				}
+			}
+			barrier.wait();
+			if (!merged) break;
+			for (uint u = lo; u < hi; ++u)
+				comp[u] = sets.findConst(u);
+		}
+	});
+}
+
+/* Roots every tree of the chosen edges at its largest node and fills in T */
+template<typename Weight, typename Node>
+void BasicGraphWU<Weight,Node>::make_forest(const vector<Edge>& E, const vector<uint>& chosen, Tree& T) const {
+	vector<uint> offset(N+1,0), adj(2*chosen.size());
+	for (uint i : chosen) {
+		++offset[E[i].u+1];
+		++offset[E[i].v+1];
+	}
+	for (uint u = 0; u < N; ++u)
+		offset[u+1] += offset[u];
+	vector<uint> fill(offset.begin(), offset.end()-1);
+	Distance sum = 0;
+	for (uint i : chosen) {
+		adj[fill[E[i].u]++] = E[i].v;
+		adj[fill[E[i].v]++] = E[i].u;
+		sum = Traits::add(sum, E[i].w);
+	}
+	T.N = N;
+	T.w = sum;
+	T.numTrees = 0;
+	T.prev.assign(N,-1);
+	vector<char> visited(N,0);
+	vector<uint> stack;
+	for (uint r = N; r-- > 0;) {
+		if (visited[r]) continue;
+		++T.numTrees;
+		visited[r] = 1;
+		stack.push_back(r);
+		while (!stack.empty()) {
+			uint u = stack.back();
+			stack.pop_back();
+			for (uint i = offset[u]; i < offset[u+1]; ++i)
+				if (!visited[adj[i]]) {
+					visited[adj[i]] = 1;
+					T.prev[adj[i]] = u;
+					stack.push_back(adj[i]);
+				}
+		}
+	}
 }
 
 
@@ -9,6 +9,8 @@
 #define GRAPH_TIME_TABLE_H_
 #include "GraphUtil.h"
 #include "PathVector.h"
+#include "SearchWorkspace.h"
+#include "IndexedHeap.h"
 
 namespace graph{
 
@@ -30,6 +32,8 @@ protected:
 public:
 	Graph_Time_Table(uint n) : N(n), edges(n) {}
 	void reset(uint n);
+	/* @return: Number of nodes */
+	uint size() const {return N;}
 	/* Add an edge between u and v with starting time t0, period P and traversal time d */
 	void addEdge(uint u, uint v, uint t0, uint P, uint d) {edges[u].push_back({v,t0,P,d});}
 	/* Begin Iterator to edges going from node u */
@@ -37,6 +41,10 @@ public:
 	/* Beyond-end Iterator to edges going from node u */
 	EdgeList::const_iterator end(uint u) const {return edges[u].end();}
 	void getShortestTime(uint s, PathVector& result) const;
+	void getShortestTime(uint s, SearchWorkspace& W) const;
+protected:
+	template<typename Labels>
+	void earliest_arrival(uint s, Labels& result, IndexedHeap<int>& q) const;
 };
 
 
@@ -57,30 +65,31 @@ void Graph_Time_Table::reset(uint n) {
  * @param: result - Path object to hold the time needed to reach each node and the
  * best path */
 void Graph_Time_Table::getShortestTime(uint s, PathVector& result) const {
-	typedef pair<uint,int> pii;
-	result.u = s;
-	auto& dist = result.dist;
-	auto& prev = result.prev;
-	dist.assign(N,inf);
-	prev.assign(N,-1);
-	auto comp = [](pii a, pii b) {
-		return a.second > b.second;
-	};
-	//Priority queue to get the node with next smallest time we can traverse edge
-	//Priority queues don't support updating of values, so we use a visited array
-	//and just add new nodes into the queue instead of updating.
-	priority_queue<pii,vector<pii>,decltype(comp)> q(comp);
+	//Priority queue to get the node with next smallest time we can traverse edge.
+	//Each node is in the queue at most once, better times are applied with decrease-key
+	IndexedHeap<int> q(N);
+	earliest_arrival(s, result, q);
+}
+
+/* @brief: Like getShortestTime(uint, PathVector&), but the result is kept in a SearchWorkspace
+ * so that the search takes time proportional to the number of nodes and edges reachable from s
+ * @param: s - source node
+ * @param: W - workspace to contain the result, reusable for any number of searches */
+void Graph_Time_Table::getShortestTime(uint s, SearchWorkspace& W) const {
+	earliest_arrival(s, W, W.q);
+}
+
+template<typename Labels>
+void Graph_Time_Table::earliest_arrival(uint s, Labels& result, IndexedHeap<int>& q) const {
+	result.start(N,s);
 	uint u,v;
 	int t,d,t0,P;
-	vector<bool> visited(N,false);
-	dist[s] = 0;
-	q.push({s,0});
+	result.set(s,0,-1);
+	q.push(s,0);
 	while (!q.empty()){
-		u = q.top().first;
-		t = q.top().second;
+		u = q.top();
+		t = q.topKey();
 		q.pop();
-		if (visited[u]) continue;
-		visited[u] = true;
 		for (auto edge = begin(u); edge != end(u); ++edge){
 			P = edge->P; t0 = edge->t0; d = edge->d; v = edge->v;
 			int newT;
@@ -92,10 +101,9 @@ void Graph_Time_Table::getShortestTime(uint s, PathVector& result) const {
 			else //P is 0 and t > t0, we can never travel to v
 				continue;
 			newT += d; //takes d time to travel
-			if (newT < dist[v]){
-				dist[v] = newT;
-				q.push({v,newT});
-				prev[v] = u;
+			if (newT < result.distance(v)){
+				result.set(v,newT,u);
+				q.update(v,newT);
 			}
 		}
 	}
@@ -0,0 +1,155 @@
+/*
+ * IndexedHeap.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef INDEXEDHEAP_H_
+#define INDEXEDHEAP_H_
+
+#include "GraphUtil.h"
+#include <functional>
+
+namespace graph {
+
+
+/*** IndexedHeap ***/
+
+/* @brief: D-ary heap over the node ids [0,n) where each node is in the heap at most once.
+ * Supports decrease-key, so the heap never holds more than n entries, and remembers
+ * which nodes have been popped (settled).
+ * @param: Key - the priority type
+ * @param: D - the arity of the heap. 4 is usually faster than a binary heap since
+ * the tree is shallower and the children of a node share a cache line
+ * @param: Compare - top() is the node whose key is smallest according to Compare */
+template<typename Key, uint D = 4, typename Compare = std::less<Key> >
+class IndexedHeap {
+	struct Entry {
+		Key key;
+		uint id;
+	};
+	enum : uint {
+		absent = ~0u, /* never pushed */
+		popped = ~0u - 1 /* pushed and popped, i.e. settled */
+	};
+	vector<Entry> heap;
+	vector<uint> pos; /* position of each node in heap, or absent/popped */
+	Compare comp;
+public:
+	IndexedHeap(uint n = 0, Compare comp = Compare()) : pos(n,absent), comp(comp) {}
+	void reset(uint n);
+	template<typename It>
+	void clear(It first, It last);
+	bool empty() const {return heap.empty();}
+	uint size() const {return heap.size();}
+	/* @return: true if u is currently in the heap */
+	bool contains(uint u) const {return pos[u] < heap.size();}
+	/* @return: true if u has been popped since the last reset */
+	bool settled(uint u) const {return pos[u] == popped;}
+	/* @return: The node with the smallest key */
+	uint top() const {return heap[0].id;}
+	/* @return: The key of top() */
+	const Key& topKey() const {return heap[0].key;}
+	/* @return: The current key of u, which must be in the heap */
+	const Key& getKey(uint u) const {return heap[pos[u]].key;}
+	void push(uint u, const Key& k);
+	void decrease(uint u, const Key& k);
+	bool update(uint u, const Key& k);
+	void pop();
+private:
+	void sift_up(uint i, Entry e);
+	void sift_down(uint i, Entry e);
+};
+
+
+
+/* Empty the heap and resize it to hold the nodes [0,n) */
+template<typename Key, uint D, typename Compare>
+void IndexedHeap<Key,D,Compare>::reset(uint n) {
+	heap.clear();
+	pos.assign(n,absent);
+}
+
+/* @brief: Empty the heap in time proportional to the number of nodes pushed since the last reset
+ * @param: first, last - range containing (at least) every node pushed since the last reset */
+template<typename Key, uint D, typename Compare>
+template<typename It>
+void IndexedHeap<Key,D,Compare>::clear(It first, It last) {
+	heap.clear();
+	for (; first != last; ++first)
+		pos[*first] = absent;
+}
+
+/* @brief: Insert node u, which must not be in the heap, with key k */
+template<typename Key, uint D, typename Compare>
+void IndexedHeap<Key,D,Compare>::push(uint u, const Key& k) {
+	heap.push_back(Entry());
+	sift_up(heap.size()-1, {k,u});
+}
+
+/* @brief: Lower the key of node u, which must be in the heap, to k */
+template<typename Key, uint D, typename Compare>
+void IndexedHeap<Key,D,Compare>::decrease(uint u, const Key& k) {
+	sift_up(pos[u], {k,u});
+}
+
+/* @brief: Insert u with key k, or lower its key to k if it is in the heap with a larger key.
+ * Settled nodes are left alone.
+ * @return: true if the heap changed */
+template<typename Key, uint D, typename Compare>
+bool IndexedHeap<Key,D,Compare>::update(uint u, const Key& k) {
+	if (pos[u] == absent) {push(u,k); return true;}
+	if (pos[u] == popped || !comp(k,heap[pos[u]].key)) return false;
+	decrease(u,k);
+	return true;
+}
+
+/* @brief: Remove top() from the heap and mark it as settled */
+template<typename Key, uint D, typename Compare>
+void IndexedHeap<Key,D,Compare>::pop() {
+	pos[heap[0].id] = popped;
+	Entry last = heap.back();
+	heap.pop_back();
+	if (!heap.empty())
+		sift_down(0,last);
+}
+
+/* Move e from position i towards the root until the heap property holds */
+template<typename Key, uint D, typename Compare>
+void IndexedHeap<Key,D,Compare>::sift_up(uint i, Entry e) {
+	while (i > 0) {
+		uint p = (i-1)/D;
+		if (!comp(e.key,heap[p].key)) break;
+		heap[i] = heap[p];
+		pos[heap[i].id] = i;
+		i = p;
+	}
+	heap[i] = e;
+	pos[e.id] = i;
+}
+
+/* Move e from position i towards the leaves until the heap property holds */
+template<typename Key, uint D, typename Compare>
+void IndexedHeap<Key,D,Compare>::sift_down(uint i, Entry e) {
+	uint n = heap.size();
+	while (true) {
+		uint c = i*D + 1;
+		if (c >= n) break;
+		uint last = min(c+D,n);
+		uint best = c;
+		for (uint j = c+1; j < last; ++j)
+			if (comp(heap[j].key,heap[best].key)) best = j;
+		if (!comp(heap[best].key,e.key)) break;
+		heap[i] = heap[best];
+		pos[heap[i].id] = i;
+		i = best;
+	}
+	heap[i] = e;
+	pos[e.id] = i;
+}
+
+
+} //namespace graph
+
+#endif /* INDEXEDHEAP_H_ */
@@ -0,0 +1,220 @@
+/*
+ * KShortestPaths.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef KSHORTESTPATHS_H_
+#define KSHORTESTPATHS_H_
+
+#include "GraphUtil.h"
+#include "GraphWDP.h"
+#include "CompactGraph.h"
+#include "SearchWorkspace.h"
+
+namespace graph {
+
+
+/*** KShortestPaths ***/
+
+/* @brief: The shortest simple paths between two nodes of a GraphWDP, in order of length, found
+ * one at a time by Yen's algorithm. Paths are sequences of nodes, so parallel edges do not give
+ * different paths. Each call to next() finds one more path, so asking for alternatives to a
+ * route costs nothing until they are needed.
+ * The distances to the target are computed once, by a search backwards from it, and every spur
+ * search is an A* search guided by them. Where the tree of shortest paths to the target is not
+ * cut off by the spur, the A* search walks straight along it. All spur searches share one
+ * SearchWorkspace, and the spurs of a path start at the node where it deviates from the path it
+ * was derived from (Lawler's improvement)
+ * @notes: The graph must not change while paths are being found. KShortestPaths uses a GraphWDP,
+ * BasicKShortestPaths<Weight,Node> a BasicGraphWDP<Weight,Node> */
+template<typename Weight = int, typename Node = uint>
+class BasicKShortestPaths {
+public:
+	typedef BasicGraphWDP<Weight,Node> Graph;
+	typedef typename Graph::Traits Traits;
+	typedef typename Graph::Distance Distance;
+	typedef typename Graph::CompactGraph CompactGraph;
+	typedef typename Graph::SearchWorkspace SearchWorkspace;
+	static constexpr Distance inf = Graph::inf;
+private:
+	struct Path {
+		Distance length;
+		vector<uint> nodes; /* from source to target */
+		vector<Distance> prefix; /* distance from the source to each node */
+		uint deviation; /* index of the first node after the root it shares with its parent */
+		bool operator<(const Path& p) const {return length < p.length || (length == p.length && nodes < p.nodes);}
+	};
+	const Graph* g;
+	CompactGraph rev; /* reverse edges of g */
+	uint s, t;
+	vector<Distance> toTarget; /* distance from each node to t */
+	vector<uint> succ; /* next node on a shortest path to t */
+	vector<Weight> succWeight;
+	vector<Path> paths;
+	set<Path> candidates;
+	SearchWorkspace W;
+	uint generation; /* number of the current spur search */
+	vector<uint> blockedNode, blockedEdge; /* generation blocking each node, or each edge from the spur node */
+public:
+	BasicKShortestPaths(const Graph& g);
+	BasicKShortestPaths(const Graph& g, uint s, uint t);
+	void start(uint s, uint t);
+	bool next();
+	/* @return: The number of paths found so far */
+	uint size() const {return paths.size();}
+	/* @return: The nodes of the i:th shortest path, from the source to the target */
+	const vector<uint>& getPath(uint i) const {return paths[i].nodes;}
+	Distance getLength(uint i) const {return paths[i].length;}
+private:
+	void search_target();
+	template<typename Adj>
+	void spur(const Adj& adj, const Path& p, uint i);
+};
+
+typedef BasicKShortestPaths<> KShortestPaths;
+
+
+template<typename Weight, typename Node>
+constexpr typename BasicKShortestPaths<Weight,Node>::Distance BasicKShortestPaths<Weight,Node>::inf;
+
+
+
+/* @brief: Prepares for finding paths in g, which start(s,t) then chooses */
+template<typename Weight, typename Node>
+BasicKShortestPaths<Weight,Node>::BasicKShortestPaths(const Graph& g) : g(&g), s(0), t(0), generation(0) {
+	if (g.isFrozen()) rev.assignReverse(g.size(), g.getCompact());
+	else rev.assignReverse(g.size(), g);
+}
+
+template<typename Weight, typename Node>
+BasicKShortestPaths<Weight,Node>::BasicKShortestPaths(const Graph& g, uint s, uint t) : BasicKShortestPaths(g) {
+	start(s,t);
+}
+
+/* @brief: Forgets the paths found so far and begins finding paths from s to t
+ * @notes: Searches the whole graph backwards from t, which is the cost of the first path */
+template<typename Weight, typename Node>
+void BasicKShortestPaths<Weight,Node>::start(uint s, uint t) {
+	this->s = s;
+	this->t = t;
+	paths.clear();
+	candidates.clear();
+	blockedNode.assign(g->size(),0);
+	blockedEdge.assign(g->size(),0);
+	generation = 0;
+	search_target();
+}
+
+/* @brief: Finds the shortest path from the source to the target that is not found yet
+ * @return: false if there are no more simple paths, otherwise the path is getPath(size()-1) */
+template<typename Weight, typename Node>
+bool BasicKShortestPaths<Weight,Node>::next() {
+	if (paths.empty()) {
+		if (toTarget[s] == inf) return false;
+		Path p;
+		p.nodes.push_back(s);
+		p.prefix.push_back(0);
+		for (uint v = s; v != t; v = succ[v]) {
+			p.nodes.push_back(succ[v]);
+			p.prefix.push_back(Traits::add(p.prefix.back(), succWeight[v]));
+		}
+		p.length = p.prefix.back();
+		p.deviation = 0;
+		paths.push_back(std::move(p));
+		return true;
+	}
+	const Path& last = paths.back();
+	for (uint i = last.deviation; i+1 < last.nodes.size(); ++i) {
+		if (g->isFrozen()) spur(g->getCompact(), last, i);
+		else spur(*g, last, i);
+	}
+	if (candidates.empty()) return false;
+	paths.push_back(*candidates.begin());
+	candidates.erase(candidates.begin());
+	return true;
+}
+
+/* Distances and shortest paths from every node to t, by Dijkstra on the reverse edges */
+template<typename Weight, typename Node>
+void BasicKShortestPaths<Weight,Node>::search_target() {
+	uint n = g->size();
+	toTarget.assign(n,inf);
+	succ.assign(n,t);
+	succWeight.resize(n);
+	IndexedHeap<Distance> q(n);
+	toTarget[t] = 0;
+	q.push(t,0);
+	while (!q.empty()) {
+		uint u = q.top();
+		q.pop();
+		for (auto edge = rev.begin(u); edge != rev.end(u); ++edge) {
+			uint v = edge->first;
+			Distance newDist = Traits::add(toTarget[u], edge->second);
+			if (newDist < toTarget[v]) {
+				toTarget[v] = newDist;
+				succ[v] = u;
+				succWeight[v] = edge->second;
+				q.update(v,newDist);
+			}
+		}
+	}
+}
+
+/* @brief: Adds to the candidates the shortest path that follows p to its i:th node and then
+ * leaves it by an edge no path found so far with the same root leaves by, if there is one
+ * @notes: A* from the spur node with the distances to t as the heuristic, which stays
+ * consistent when nodes and edges are removed */
+template<typename Weight, typename Node>
+template<typename Adj>
+void BasicKShortestPaths<Weight,Node>::spur(const Adj& adj, const Path& p, uint i) {
+	uint root = p.nodes[i];
+	if (++generation == 0) { //wrapped around, old marks could match again
+		std::fill(blockedNode.begin(), blockedNode.end(), 0);
+		std::fill(blockedEdge.begin(), blockedEdge.end(), 0);
+		generation = 1;
+	}
+	for (uint j = 0; j < i; ++j)
+		blockedNode[p.nodes[j]] = generation;
+	for (const Path& q : paths)
+		if (q.nodes.size() > i+1 && std::equal(p.nodes.begin(), p.nodes.begin()+i+1, q.nodes.begin()))
+			blockedEdge[q.nodes[i+1]] = generation;
+
+	W.start(g->size(), root);
+	W.set(root,0,-1);
+	W.q.push(root,toTarget[root]);
+	while (!W.q.empty()) {
+		uint u = W.q.top();
+		if (u == t) break;
+		W.q.pop();
+		Distance d = W.distance(u);
+		for (auto edge = adj.begin(u); edge != adj.end(u); ++edge) {
+			uint v = edge->first;
+			if (blockedNode[v] == generation || toTarget[v] == inf) continue;
+			if (u == root && blockedEdge[v] == generation) continue;
+			Distance newDist = Traits::add(d, edge->second);
+			if (newDist < W.distance(v)) {
+				W.set(v,newDist,u);
+				W.q.update(v,Traits::add(newDist, toTarget[v]));
+			}
+		}
+	}
+	if (!W.reached(t)) return;
+
+	Path c;
+	c.nodes.assign(p.nodes.begin(), p.nodes.begin()+i);
+	c.prefix.assign(p.prefix.begin(), p.prefix.begin()+i);
+	W.getPath(t, std::back_inserter(c.nodes));
+	std::reverse(c.nodes.begin()+i, c.nodes.end());
+	for (uint j = i; j < c.nodes.size(); ++j)
+		c.prefix.push_back(Traits::add(p.prefix[i], W.distance(c.nodes[j])));
+	c.length = c.prefix.back();
+	c.deviation = i;
+	candidates.insert(std::move(c));
+}
+
+
+} //namespace graph
+
+#endif /* KSHORTESTPATHS_H_ */
@@ -0,0 +1,248 @@
+/*
+ * MonotoneQueue.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef MONOTONEQUEUE_H_
+#define MONOTONEQUEUE_H_
+
+#include "GraphUtil.h"
+
+namespace graph {
+
+
+/* Monotone integer priority queues over the node ids [0,n).
+ * They have the same interface as IndexedHeap, but every key pushed must be at least
+ * as large as the key last popped, which always holds in Dijkstra's algorithm with
+ * nonnegative integer weights. Each node is in a queue at most once and lowering its key
+ * moves it to another bucket, so the queues never hold more than n entries. */
+
+
+/*** RadixHeap ***/
+
+/* @brief: Radix heap. Bucket i > 0 holds the keys whose highest bit differing from
+ * the last popped key is bit i-1, and bucket 0 holds keys equal to it. Each key moves
+ * to a lower bucket at most 32 times, so any range of nonnegative keys is handled
+ * in O(log C) amortized time per node where C is the largest edge weight */
+class RadixHeap {
+	static const uint numBuckets = std::numeric_limits<uint>::digits + 1;
+	enum : uint {
+		absent = ~0u, /* never pushed */
+		popped = ~0u - 1 /* pushed and popped, i.e. settled */
+	};
+	vector<uint> buckets[numBuckets];
+	vector<uint> key;
+	vector<uint> where; /* bucket holding each node, or absent/popped */
+	vector<uint> idx; /* position of each node within its bucket */
+	uint last; /* last popped key */
+	uint count;
+public:
+	RadixHeap(uint n = 0) {reset(n);}
+	void reset(uint n);
+	bool empty() const {return count == 0;}
+	uint size() const {return count;}
+	bool contains(uint u) const {return where[u] < numBuckets;}
+	bool settled(uint u) const {return where[u] == popped;}
+	/* @return: A node with the smallest key */
+	uint top() {refill(); return buckets[0].back();}
+	/* @return: The key of top() */
+	uint topKey() {refill(); return last;}
+	uint getKey(uint u) const {return key[u];}
+	void push(uint u, uint k);
+	void decrease(uint u, uint k);
+	bool update(uint u, uint k);
+	void pop();
+private:
+	uint bucket_of(uint k) const {return k == last ? 0 : numBuckets - 1 - __builtin_clz(k ^ last);}
+	void insert(uint u, uint b);
+	void remove(uint u);
+	void refill();
+};
+
+
+
+/* Empty the heap and resize it to hold the nodes [0,n) */
+void RadixHeap::reset(uint n) {
+	for (uint b = 0; b < numBuckets; ++b)
+		buckets[b].clear();
+	key.resize(n);
+	where.assign(n,absent);
+	idx.resize(n);
+	last = 0;
+	count = 0;
+}
+
+/* @brief: Insert node u, which must not be in the heap, with key k >= the last popped key */
+void RadixHeap::push(uint u, uint k) {
+	key[u] = k;
+	insert(u,bucket_of(k));
+	++count;
+}
+
+/* @brief: Lower the key of node u, which must be in the heap, to k >= the last popped key */
+void RadixHeap::decrease(uint u, uint k) {
+	remove(u);
+	key[u] = k;
+	insert(u,bucket_of(k));
+}
+
+/* @brief: Insert u with key k, or lower its key to k if it is in the heap with a larger key.
+ * Settled nodes are left alone.
+ * @return: true if the heap changed */
+bool RadixHeap::update(uint u, uint k) {
+	if (where[u] == absent) {push(u,k); return true;}
+	if (where[u] == popped || k >= key[u]) return false;
+	decrease(u,k);
+	return true;
+}
+
+/* @brief: Remove top() from the heap and mark it as settled */
+void RadixHeap::pop() {
+	refill();
+	uint u = buckets[0].back();
+	buckets[0].pop_back();
+	where[u] = popped;
+	--count;
+}
+
+void RadixHeap::insert(uint u, uint b) {
+	where[u] = b;
+	idx[u] = buckets[b].size();
+	buckets[b].push_back(u);
+}
+
+/* Swap u with the last node of its bucket and drop it */
+void RadixHeap::remove(uint u) {
+	vector<uint>& bucket = buckets[where[u]];
+	uint v = bucket.back();
+	bucket[idx[u]] = v;
+	idx[v] = idx[u];
+	bucket.pop_back();
+}
+
+/* Make sure bucket 0 is non-empty by redistributing the first non-empty bucket around its minimum */
+void RadixHeap::refill() {
+	if (!buckets[0].empty()) return;
+	uint b = 1;
+	while (buckets[b].empty()) ++b;
+	vector<uint> moved;
+	moved.swap(buckets[b]);
+	last = key[moved[0]];
+	for (uint i = 1; i < moved.size(); ++i)
+		last = min(last,key[moved[i]]);
+	//every key of bucket b now has its highest differing bit below bit b-1, so they move to lower buckets
+	for (uint i = 0; i < moved.size(); ++i)
+		insert(moved[i],bucket_of(key[moved[i]]));
+	moved.clear();
+	moved.swap(buckets[b]); //keep the allocation
+}
+
+
+/*** BucketQueue ***/
+
+/* @brief: Dial's bucket queue. When the largest edge weight is C, all keys in the queue
+ * lie in [last, last+C], so a circular array of C+1 buckets indexed by key%(C+1)
+ * holds them and finding the next key is a linear scan over at most C+1 buckets.
+ * Best when C is small compared to the number of nodes */
+class BucketQueue {
+	enum : uint {
+		absent = ~0u, /* never pushed */
+		popped = ~0u - 1 /* pushed and popped, i.e. settled */
+	};
+	vector<vector<uint> > buckets;
+	vector<uint> key;
+	vector<uint> where; /* bucket holding each node, or absent/popped */
+	vector<uint> idx; /* position of each node within its bucket */
+	uint last; /* smallest key that may still be in the queue */
+	uint count;
+public:
+	BucketQueue(uint n = 0, uint maxWeight = 0) {reset(n,maxWeight);}
+	void reset(uint n, uint maxWeight);
+	bool empty() const {return count == 0;}
+	uint size() const {return count;}
+	bool contains(uint u) const {return where[u] < buckets.size();}
+	bool settled(uint u) const {return where[u] == popped;}
+	/* @return: A node with the smallest key */
+	uint top() {advance(); return buckets[last % buckets.size()].back();}
+	/* @return: The key of top() */
+	uint topKey() {advance(); return last;}
+	uint getKey(uint u) const {return key[u];}
+	void push(uint u, uint k);
+	void decrease(uint u, uint k);
+	bool update(uint u, uint k);
+	void pop();
+private:
+	void insert(uint u, uint b);
+	void remove(uint u);
+	void advance() {while (buckets[last % buckets.size()].empty()) ++last;}
+};
+
+
+
+/* Empty the queue and resize it to hold the nodes [0,n) with edge weights up to maxWeight */
+void BucketQueue::reset(uint n, uint maxWeight) {
+	buckets.resize(maxWeight+1);
+	for (uint b = 0; b <= maxWeight; ++b)
+		buckets[b].clear();
+	key.resize(n);
+	where.assign(n,absent);
+	idx.resize(n);
+	last = 0;
+	count = 0;
+}
+
+/* @brief: Insert node u, which must not be in the queue, with key k in [last popped key, last popped key + maxWeight] */
+void BucketQueue::push(uint u, uint k) {
+	key[u] = k;
+	insert(u,k % buckets.size());
+	++count;
+}
+
+/* @brief: Lower the key of node u, which must be in the queue, to k >= the last popped key */
+void BucketQueue::decrease(uint u, uint k) {
+	remove(u);
+	key[u] = k;
+	insert(u,k % buckets.size());
+}
+
+/* @brief: Insert u with key k, or lower its key to k if it is in the queue with a larger key.
+ * Settled nodes are left alone.
+ * @return: true if the queue changed */
+bool BucketQueue::update(uint u, uint k) {
+	if (where[u] == absent) {push(u,k); return true;}
+	if (where[u] == popped || k >= key[u]) return false;
+	decrease(u,k);
+	return true;
+}
+
+/* @brief: Remove top() from the queue and mark it as settled */
+void BucketQueue::pop() {
+	advance();
+	vector<uint>& bucket = buckets[last % buckets.size()];
+	uint u = bucket.back();
+	bucket.pop_back();
+	where[u] = popped;
+	--count;
+}
+
+void BucketQueue::insert(uint u, uint b) {
+	where[u] = b;
+	idx[u] = buckets[b].size();
+	buckets[b].push_back(u);
+}
+
+/* Swap u with the last node of its bucket and drop it */
+void BucketQueue::remove(uint u) {
+	vector<uint>& bucket = buckets[where[u]];
+	uint v = bucket.back();
+	bucket[idx[u]] = v;
+	idx[v] = idx[u];
+	bucket.pop_back();
+}
+
+
+} //namespace graph
+
+#endif /* MONOTONEQUEUE_H_ */
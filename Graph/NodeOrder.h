@@ -0,0 +1,243 @@
+/*
+ * NodeOrder.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef NODEORDER_H_
+#define NODEORDER_H_
+
+#include "GraphUtil.h"
+#include "PathVector.h"
+#include "PathMatrix.h"
+#include <cstdint>
+
+namespace graph {
+
+
+/*** NodeOrder ***/
+
+/* @brief: A renumbering of the nodes of a graph. Searches touch the distances and
+ * predecessors of a node's neighbours, so numbering nodes that are close in the graph
+ * close to each other keeps those accesses within fewer cache lines.
+ * Compute an order with one of bfs, rcm, degree or hilbert, renumber the graph with its
+ * permute method, and translate query results back with toOriginal.
+ * @notes: Queries on the renumbered graph take new ids, e.g. getShortestDistance(order.newId(s), P) */
+class NodeOrder {
+	vector<uint> order; /* new id of each original node */
+	vector<uint> original; /* original id of each new node */
+public:
+	uint size() const {return order.size();}
+	uint newId(uint v) const {return order[v];}
+	uint originalId(uint i) const {return original[i];}
+	/* @return: The permutation, element v being the new id of node v */
+	const vector<uint>& getPermutation() const {return order;}
+	/* @return: The inverse permutation, element i being the original id of new node i */
+	const vector<uint>& getInverse() const {return original;}
+	void assign(const vector<uint>& permutation);
+	template<typename Graph>
+	void bfs(const Graph& g);
+	template<typename Graph>
+	void rcm(const Graph& g);
+	template<typename Graph>
+	void degree(const Graph& g);
+	void hilbert(const vector<double>& x, const vector<double>& y);
+	template<typename Distance, typename Index>
+	void toOriginal(BasicPathVector<Distance,Index>& P) const;
+	template<typename Distance, typename Index>
+	void toOriginal(BasicPathMatrix<Distance,Index>& P) const;
+private:
+	void set_sequence(vector<uint>& sequence);
+	template<typename Adj>
+	void cuthill_mckee(const Adj& g, uint n, vector<uint>& sequence) const;
+	template<typename Adj>
+	static void degrees(const Adj& g, uint n, vector<uint>& deg);
+	static uint head(uint v) {return v;}
+	template<typename Node, typename Weight>
+	static uint head(const pair<Node,Weight>& e) {return e.first;}
+	static uint64_t hilbert_index(uint x, uint y);
+};
+
+
+
+/* @brief: Use the given permutation
+ * @param: permutation - element v is the new id of node v */
+void NodeOrder::assign(const vector<uint>& permutation) {
+	order = permutation;
+	original.resize(order.size());
+	for (uint v = 0; v < order.size(); ++v)
+		original[order[v]] = v;
+}
+
+/* Numbers the nodes in the order of sequence, which is moved into original */
+void NodeOrder::set_sequence(vector<uint>& sequence) {
+	original.swap(sequence);
+	order.resize(original.size());
+	for (uint i = 0; i < original.size(); ++i)
+		order[original[i]] = i;
+}
+
+/* @brief: Breadth first order (Cuthill-McKee). Each search starts from the unnumbered node of
+ * lowest degree and numbers the neighbours of a node by increasing degree, so that every node
+ * gets an id close to the ids of its neighbours
+ * @param: g - GraphD, GraphWD, GraphWDP or GraphWU, frozen or not
+ * @notes: The searches follow the edges of directed graphs forwards only */
+template<typename Graph>
+void NodeOrder::bfs(const Graph& g) {
+	vector<uint> sequence;
+	if (g.isFrozen()) cuthill_mckee(g.getCompact(), g.size(), sequence);
+	else cuthill_mckee(g, g.size(), sequence);
+	set_sequence(sequence);
+}
+
+/* @brief: Reverse Cuthill-McKee, the breadth first order backwards, which tends to keep
+ * the ids of neighbours even closer on sparse graphs
+ * @param: g - GraphD, GraphWD, GraphWDP or GraphWU, frozen or not */
+template<typename Graph>
+void NodeOrder::rcm(const Graph& g) {
+	vector<uint> sequence;
+	if (g.isFrozen()) cuthill_mckee(g.getCompact(), g.size(), sequence);
+	else cuthill_mckee(g, g.size(), sequence);
+	std::reverse(sequence.begin(), sequence.end());
+	set_sequence(sequence);
+}
+
+/* @brief: Nodes by decreasing number of edges, ties by original id. The nodes of high degree
+ * that most searches pass through end up next to each other
+ * @param: g - GraphD, GraphWD, GraphWDP or GraphWU, frozen or not */
+template<typename Graph>
+void NodeOrder::degree(const Graph& g) {
+	uint n = g.size();
+	vector<uint> deg, sequence(n);
+	if (g.isFrozen()) degrees(g.getCompact(), n, deg);
+	else degrees(g, n, deg);
+	for (uint v = 0; v < n; ++v)
+		sequence[v] = v;
+	std::stable_sort(sequence.begin(), sequence.end(), [&](uint a, uint b) {return deg[a] > deg[b];});
+	set_sequence(sequence);
+}
+
+/* @brief: Nodes in the order they are visited by a Hilbert curve through the plane,
+ * so nodes close in the plane get close ids. Suits road networks and other graphs whose
+ * edges mostly join nearby points
+ * @param: x, y - coordinates of each node */
+void NodeOrder::hilbert(const vector<double>& x, const vector<double>& y) {
+	uint n = x.size();
+	vector<uint> sequence(n);
+	vector<uint64_t> key(n);
+	if (n > 0) {
+		double x0 = *std::min_element(x.begin(), x.end()), x1 = *std::max_element(x.begin(), x.end());
+		double y0 = *std::min_element(y.begin(), y.end()), y1 = *std::max_element(y.begin(), y.end());
+		//scale both axes by the same factor onto a 2^16 x 2^16 grid
+		double scale = 65535 / max(max(x1 - x0, y1 - y0), 1e-300);
+		for (uint v = 0; v < n; ++v)
+			key[v] = hilbert_index((uint)((x[v] - x0) * scale), (uint)((y[v] - y0) * scale));
+	}
+	for (uint v = 0; v < n; ++v)
+		sequence[v] = v;
+	std::stable_sort(sequence.begin(), sequence.end(), [&](uint a, uint b) {return key[a] < key[b];});
+	set_sequence(sequence);
+}
+
+/* @brief: Renumbers a result computed on the renumbered graph to the original ids
+ * @param: P - result of a single source search on the renumbered graph */
+template<typename Distance, typename Index>
+void NodeOrder::toOriginal(BasicPathVector<Distance,Index>& P) const {
+	uint n = order.size();
+	vector<Distance> dist(n);
+	vector<Index> prev(n);
+	for (uint v = 0; v < n; ++v) {
+		dist[v] = P.dist[order[v]];
+		int p = P.previous(order[v]);
+		prev[v] = (Index)(p < 0 ? p : (int)original[p]);
+	}
+	P.u = original[P.u];
+	P.dist.swap(dist);
+	P.prev.swap(prev);
+}
+
+/* @brief: Renumbers the rows and columns of a result computed on the renumbered graph
+ * to the original ids
+ * @param: P - result of an all pairs search on the renumbered graph, in any PathMode */
+template<typename Distance, typename Index>
+void NodeOrder::toOriginal(BasicPathMatrix<Distance,Index>& P) const {
+	uint n = order.size();
+	typename BasicPathMatrix<Distance,Index>::Buffer dist(P.dist.size());
+	typename BasicPathMatrix<Distance,Index>::PrevBuffer prev(P.prev.size());
+	for (uint u = 0; u < n; ++u) {
+		const Distance* d = &P.dist[P.index(order[u],0)];
+		size_t from = P.index(order[u],0), row = P.index(u,0);
+		for (uint v = 0; v < n; ++v) {
+			dist[row+v] = d[order[v]];
+			if (!P.hasPaths()) continue;
+			int q = P.get_pred(P.prev, from + order[v]);
+			P.set_pred(prev, row+v, q < 0 ? q : (int)original[q]);
+		}
+	}
+	P.dist.swap(dist);
+	P.prev.swap(prev);
+}
+
+template<typename Adj>
+void NodeOrder::degrees(const Adj& g, uint n, vector<uint>& deg) {
+	deg.assign(n,0);
+	for (uint u = 0; u < n; ++u)
+		for (auto e = g.begin(u); e != g.end(u); ++e)
+			++deg[u];
+}
+
+template<typename Adj>
+void NodeOrder::cuthill_mckee(const Adj& g, uint n, vector<uint>& sequence) const {
+	vector<uint> deg, start(n), next;
+	degrees(g, n, deg);
+	auto byDegree = [&](uint a, uint b) {return deg[a] < deg[b] || (deg[a] == deg[b] && a < b);};
+	for (uint v = 0; v < n; ++v)
+		start[v] = v;
+	std::sort(start.begin(), start.end(), byDegree);
+	vector<bool> visited(n,false);
+	sequence.clear();
+	sequence.reserve(n);
+	for (uint s : start) {
+		if (visited[s]) continue;
+		visited[s] = true;
+		sequence.push_back(s);
+		//the sequence doubles as the queue of the search
+		for (size_t i = sequence.size()-1; i < sequence.size(); ++i) {
+			uint u = sequence[i];
+			next.clear();
+			for (auto e = g.begin(u); e != g.end(u); ++e) {
+				uint v = head(*e);
+				if (!visited[v]) {
+					visited[v] = true;
+					next.push_back(v);
+				}
+			}
+			std::sort(next.begin(), next.end(), byDegree);
+			sequence.insert(sequence.end(), next.begin(), next.end());
+		}
+	}
+}
+
+/* @return: Position of (x,y) along the Hilbert curve through the 2^16 x 2^16 grid */
+uint64_t NodeOrder::hilbert_index(uint x, uint y) {
+	uint64_t d = 0;
+	for (uint s = 1u << 15; s > 0; s /= 2) {
+		uint rx = (x & s) > 0, ry = (y & s) > 0;
+		d += (uint64_t)s * s * ((3 * rx) ^ ry);
+		//rotate the quadrant so the curve continues where it left off
+		if (ry == 0) {
+			if (rx == 1) {
+				x = s-1 - (x & (s-1));
+				y = s-1 - (y & (s-1));
+			}
+			std::swap(x,y);
+		}
+	}
+	return d;
+}
+
+
+} //namespace graph
+
+#endif /* NODEORDER_H_ */
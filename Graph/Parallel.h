@@ -0,0 +1,103 @@
+/*
+ * Parallel.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include "GraphUtil.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace graph {
+
+
+/* @return: n, or the number of hardware threads if n is 0 */
+uint getNumThreads(uint n) {
+	if (n > 0) return n;
+	n = std::thread::hardware_concurrency();
+	return n > 0 ? n : 1;
+}
+
+
+/*** Barrier ***/
+
+/* @brief: Blocks each of n threads in wait() until all n have called it. Reusable */
+class Barrier {
+	std::mutex m;
+	std::condition_variable cv;
+	uint n, waiting, generation;
+public:
+	Barrier(uint n) : n(n), waiting(0), generation(0) {}
+	void wait();
+};
+
+void Barrier::wait() {
+	std::unique_lock<std::mutex> lock(m);
+	uint gen = generation;
+	if (++waiting == n) {
+		waiting = 0;
+		++generation;
+		cv.notify_all();
+		return;
+	}
+	cv.wait(lock, [&]{return gen != generation;});
+}
+
+
+/* @brief: Runs f(t) for t = [0,numThreads) on numThreads threads, the calling thread being
+ * thread 0, and returns when all are done */
+template<typename F>
+void runThreads(uint numThreads, F f) {
+	vector<std::thread> threads;
+	for (uint t = 1; t < numThreads; ++t)
+		threads.push_back(std::thread(f,t));
+	f(0);
+	for (auto& th : threads)
+		th.join();
+}
+
+/* @brief: Calls f(i,t) for every task i = [0,numTasks) on numThreads threads, where t = [0,numThreads)
+ * is the thread running the task so that each thread can reuse its own scratch space. Threads take
+ * the next task from a shared counter, which balances tasks of different sizes
+ * @param: numThreads - 0 to use one thread per hardware thread */
+template<typename F>
+void runTasks(uint numTasks, uint numThreads, F f) {
+	std::atomic<uint> next(0);
+	runThreads(getNumThreads(numThreads), [&](uint t) {
+		for (uint i = next++; i < numTasks; i = next++)
+			f(i,t);
+	});
+}
+
+/* @brief: Sorts [first,last) like std::sort using numThreads threads. Each thread sorts
+ * a slice, then neighbouring sorted runs are merged in parallel until one run is left */
+template<typename RandomIt, typename Compare>
+void parallelSort(RandomIt first, RandomIt last, Compare comp, uint numThreads = 0) {
+	size_t n = last - first;
+	uint T = getNumThreads(numThreads);
+	if (T > n/4096) T = max<size_t>(1, n/4096);
+	if (T == 1) {std::sort(first,last,comp); return;}
+	vector<size_t> bound(T+1);
+	for (uint t = 0; t <= T; ++t)
+		bound[t] = n*t/T;
+	runThreads(T, [&](uint t) {std::sort(first + bound[t], first + bound[t+1], comp);});
+	for (uint width = 1; width < T; width *= 2) {
+		uint pairs = (T + 2*width - 1) / (2*width);
+		runThreads(pairs, [&](uint p) {
+			uint lo = 2*width*p, mid = min(lo + width, T), hi = min(lo + 2*width, T);
+			if (mid < hi)
+				std::inplace_merge(first + bound[lo], first + bound[mid], first + bound[hi], comp);
+		});
+	}
+}
+
+
+} //namespace graph
+
+#endif /* PARALLEL_H_ */
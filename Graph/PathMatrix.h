@@ -9,34 +9,114 @@
 #define PATHMATRIX_H_
 
 #include "GraphUtil.h"
+#include <cstdint>
 
 namespace graph{
 
 /*** PathMatrix ***/
 
-/* @brief: Class for holding the path between any pairs of nodes */
-class PathMatrix {
-	vector<vector<int> > dist;
-	vector<vector<int> > prev;
+/* @brief: Class for holding the path between any pairs of nodes, with distances of type Distance
+ * and predecessors of at most the size of Index, see NodeTraits.
+ * The distances and predecessors are each stored in one contiguous buffer, row by row,
+ * with every row starting on a 64 byte boundary. How much of the paths is kept is set by
+ * the PathMode, which takes effect at the next search filling in the matrix
+ * @notes: To process one row at a time without keeping the matrix at all, see
+ * GraphWD::getShortestDistanceRows */
+template<typename Distance, typename Index = int>
+class BasicPathMatrix {
 public:
+	/* What is stored besides the distances
+	 * FULL_PATHS - a predecessor of type Index per pair
+	 * COMPACT_PATHS - a predecessor per pair in the narrowest of uint8_t, uint16_t and int that
+	 * holds every node, e.g. half the memory of FULL_PATHS for up to 65535 nodes
+	 * DISTANCE_ONLY - no predecessors, getPath writes nothing */
+	enum PathMode { FULL_PATHS, COMPACT_PATHS, DISTANCE_ONLY };
+	typedef vector<Distance,AlignedAllocator<Distance,64> > Buffer;
+	typedef vector<unsigned char,AlignedAllocator<unsigned char,64> > PrevBuffer;
+	static constexpr Distance inf = WeightTraits<Distance>::inf();
+	static constexpr Distance neginf = WeightTraits<Distance>::neginf();
+private:
+	uint N;
+	uint stride; /* elements per row, N rounded up to a whole number of cache lines */
+	PathMode mode;
+	uint predSize; /* bytes per predecessor, 0 if there are none */
+	Buffer dist;
+	PrevBuffer prev; /* predecessors of type uint8_t, uint16_t or int by predSize, all ones if there is none */
+	void resize(uint n);
+	std::size_t index(uint u, uint v) const {return (std::size_t)u*stride + v;}
+	/* @return: Row u of the predecessors as Pred, which must have predSize bytes, or null if there are none */
+	template<typename Pred>
+	Pred* predecessors(uint u) {return predSize ? reinterpret_cast<Pred*>(prev.data()) + index(u,0) : 0;}
+	int get_pred(const PrevBuffer& b, std::size_t i) const;
+	void set_pred(PrevBuffer& b, std::size_t i, int p) const;
+public:
+	BasicPathMatrix(PathMode mode = FULL_PATHS) : N(0), stride(0), mode(mode), predSize(0) {}
+	uint size() const {return N;}
+	/* Set what the next search stores, see PathMode */
+	void setMode(PathMode m) {mode = m;}
+	PathMode getMode() const {return mode;}
+	/* @return: Whether the matrix holds predecessors, so that getPath works */
+	bool hasPaths() const {return predSize > 0;}
 	template<typename OutIter>
 	OutIter getPath(uint u, uint v, OutIter out) const;
-	int getDistance(uint u, uint v) const {return dist[u][v];}
-	friend class GraphWD;
+	Distance getDistance(uint u, uint v) const {return dist[index(u,v)];}
+	template<typename, typename> friend class BasicGraphWD;
+	friend class NodeOrder;
 };
 
+typedef BasicPathMatrix<int> PathMatrix;
+
+
+template<typename Distance, typename Index>
+constexpr Distance BasicPathMatrix<Distance,Index>::inf;
+template<typename Distance, typename Index>
+constexpr Distance BasicPathMatrix<Distance,Index>::neginf;
+
+
 
+/* Resize to n x n with predecessors as the mode asks for, the contents are unspecified */
+template<typename Distance, typename Index>
+void BasicPathMatrix<Distance,Index>::resize(uint n) {
+	N = n;
+	if (mode == DISTANCE_ONLY) predSize = 0;
+	else if (mode == COMPACT_PATHS && n <= 0xff) predSize = 1; //all ones is left for no predecessor
+	else if (mode == COMPACT_PATHS && n <= 0xffff) predSize = 2;
+	else predSize = sizeof(Index);
+	//rows of both buffers must start on a cache line
+	uint unit = 64 / (predSize ? min<uint>(predSize, sizeof(Distance)) : sizeof(Distance));
+	stride = (n + unit-1) / unit * unit;
+	dist.resize((std::size_t)n*stride);
+	if (predSize) prev.resize((std::size_t)n*stride*predSize);
+	else PrevBuffer().swap(prev);
+}
+
+/* @return: Predecessor i of b, -1 if there is none */
+template<typename Distance, typename Index>
+int BasicPathMatrix<Distance,Index>::get_pred(const PrevBuffer& b, std::size_t i) const {
+	if (predSize == 1) {uint8_t p = b[i]; return p == 0xff ? -1 : p;}
+	if (predSize == 2) {uint16_t p = reinterpret_cast<const uint16_t*>(b.data())[i]; return p == 0xffff ? -1 : p;}
+	return reinterpret_cast<const int*>(b.data())[i];
+}
+
+/* Store p, or -1 for no predecessor, as predecessor i of b */
+template<typename Distance, typename Index>
+void BasicPathMatrix<Distance,Index>::set_pred(PrevBuffer& b, std::size_t i, int p) const {
+	if (predSize == 1) b[i] = (uint8_t)p;
+	else if (predSize == 2) reinterpret_cast<uint16_t*>(b.data())[i] = (uint16_t)p;
+	else reinterpret_cast<int*>(b.data())[i] = p;
+}
 
 /* @brief: Writes nodes in shortest path between u and v starting
- * from v and ending at u (inclusive)
+ * from v and ending at u (inclusive). Nothing is written in DISTANCE_ONLY mode
  * @return: beyond-end iterator of output range */
+template<typename Distance, typename Index>
 template<typename OutIter>
-OutIter PathMatrix::getPath(uint u, uint v, OutIter out) const {
+OutIter BasicPathMatrix<Distance,Index>::getPath(uint u, uint v, OutIter out) const {
 	//no path exists or negative cycle
-	if (dist[u][v] == inf || dist[u][v] == neginf) return out;
+	if (getDistance(u,v) == inf || getDistance(u,v) == neginf || !predSize) return out;
 	while (v != u){
 		*out = v; ++out;
-		v = prev[u][v];
+		v = get_pred(prev, index(u,v));
 	}
 	*out = v; ++out;
 	return out;
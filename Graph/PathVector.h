@@ -15,27 +15,52 @@ namespace graph {
 /*** PathVector ***/
 
 /* @brief: Class for holding the path between a source node and
- * all other nodes */
-class PathVector {
+ * all other nodes, with distances of type Distance and predecessors of type Index
+ * @notes: PathVector holds int distances and predecessors, the types of BasicGraphWD<Weight,Node>
+ * are WeightTraits<Weight>::Distance and NodeTraits<Node>::Index */
+template<typename Distance, typename Index = int>
+class BasicPathVector {
 	uint u; /* source node */
-	vector<int> dist;
-	vector<int> prev;
+	vector<Distance> dist;
+	vector<Index> prev; /* all ones for none */
 public:
-	int getDistance(uint v) const {return dist[v];}
+	static constexpr Distance inf = WeightTraits<Distance>::inf();
+	static constexpr Distance neginf = WeightTraits<Distance>::neginf();
+	Distance getDistance(uint v) const {return dist[v];}
 	template<typename OutIter>
 	OutIter getPath(uint v, OutIter out) const;
 	uint getSource() const {return u;}
-	friend class GraphWD;
-	friend class GraphWDP;
+	friend class GraphD;
+	template<typename, typename> friend class BasicGraphWD;
+	template<typename, typename> friend class BasicGraphWDP;
 	friend class Graph_Time_Table;
+	friend class DeltaStepping;
+	friend class ConnectionScan;
+	friend class NodeOrder;
+private:
+	/* Interface shared with SearchWorkspace, used by searches that can fill in either */
+	void start(uint n, uint s) {u = s; dist.assign(n,inf); prev.assign(n,(Index)-1);}
+	bool reached(uint v) const {return dist[v] != inf;}
+	Distance distance(uint v) const {return dist[v];}
+	int previous(uint v) const {return prev[v] == (Index)-1 ? -1 : (int)prev[v];}
+	void set(uint v, Distance d, int p) {dist[v] = d; prev[v] = (Index)p;}
 };
 
+typedef BasicPathVector<int> PathVector;
+
+
+template<typename Distance, typename Index>
+constexpr Distance BasicPathVector<Distance,Index>::inf;
+template<typename Distance, typename Index>
+constexpr Distance BasicPathVector<Distance,Index>::neginf;
+
 
 /* @brief: Writes nodes in shortest path between source node and v to out
  * starting from v and ending at source (inclusive)
  * @return: beyond-end iterator of output range */
+template<typename Distance, typename Index>
 template<typename OutIter>
-OutIter PathVector::getPath(uint v, OutIter out) const {
+OutIter BasicPathVector<Distance,Index>::getPath(uint v, OutIter out) const {
 	//no path exists or negative cycle
 	if (dist[v] == inf || dist[v] == neginf) return out;
 	while (v != u){
@@ -0,0 +1,119 @@
+/*
+ * SearchWorkspace.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef SEARCHWORKSPACE_H_
+#define SEARCHWORKSPACE_H_
+
+#include "GraphUtil.h"
+#include "IndexedHeap.h"
+
+namespace graph {
+
+
+/*** SearchWorkspace ***/
+
+/* @brief: Holds the result of a single source search like a PathVector, but is meant to be
+ * reused for many searches. Each node has the number of the search that last reached it, so
+ * starting a new search does not touch the nodes the previous one reached, and a search costs
+ * time proportional to the part of the graph it visits rather than to the size of the graph.
+ * The arrays only grow, to the size of the largest graph searched
+ * @notes: Pass it to the getShortestDistance/getShortestTime overloads taking a SearchWorkspace,
+ * a BasicSearchWorkspace<Distance> for the graphs whose distances are of type Distance */
+template<typename Distance>
+class BasicSearchWorkspace {
+	uint u; /* source node */
+	uint generation; /* number of the current search */
+	vector<uint> stamp; /* generation of the search that last reached each node */
+	vector<Distance> dist;
+	vector<int> prev;
+	vector<uint> touched; /* nodes reached by the current search, in the order they were reached */
+	IndexedHeap<Distance> q;
+	vector<uint> buffer; /* per-node scratch space of the searches, never cleared */
+public:
+	static constexpr Distance inf = WeightTraits<Distance>::inf();
+	static constexpr Distance neginf = WeightTraits<Distance>::neginf();
+	BasicSearchWorkspace() : u(0), generation(1) {}
+	/* @return: Whether the last search reached v */
+	bool reached(uint v) const {return v < stamp.size() && stamp[v] == generation;}
+	Distance getDistance(uint v) const {return reached(v) ? dist[v] : inf;}
+	template<typename OutIter>
+	OutIter getPath(uint v, OutIter out) const;
+	uint getSource() const {return u;}
+	/* @return: The nodes reached by the last search, in the order they were first reached */
+	const vector<uint>& getReached() const {return touched;}
+	template<typename, typename> friend class BasicGraphWD;
+	template<typename, typename> friend class BasicGraphWDP;
+	template<typename, typename> friend class BasicDijkstraSearch;
+	template<typename, typename> friend class BasicKShortestPaths;
+	friend class Graph_Time_Table;
+private:
+	void start(uint n, uint s);
+	Distance distance(uint v) const {return getDistance(v);}
+	int previous(uint v) const {return reached(v) ? prev[v] : -1;}
+	void set(uint v, Distance d, int p);
+};
+
+typedef BasicSearchWorkspace<int> SearchWorkspace;
+
+
+template<typename Distance>
+constexpr Distance BasicSearchWorkspace<Distance>::inf;
+template<typename Distance>
+constexpr Distance BasicSearchWorkspace<Distance>::neginf;
+
+
+
+/* Begin a new search from s in a graph with n nodes */
+template<typename Distance>
+void BasicSearchWorkspace<Distance>::start(uint n, uint s) {
+	if (stamp.size() < n) {
+		stamp.resize(n,0);
+		dist.resize(n);
+		prev.resize(n);
+		q.reset(n);
+	}
+	else
+		q.clear(touched.begin(), touched.end());
+	if (++generation == 0) { //wrapped around, old stamps could match again
+		std::fill(stamp.begin(), stamp.end(), 0);
+		generation = 1;
+	}
+	touched.clear();
+	u = s;
+}
+
+/* Set the distance and previous node of v, marking it as reached */
+template<typename Distance>
+void BasicSearchWorkspace<Distance>::set(uint v, Distance d, int p) {
+	if (stamp[v] != generation) {
+		stamp[v] = generation;
+		touched.push_back(v);
+	}
+	dist[v] = d;
+	prev[v] = p;
+}
+
+/* @brief: Writes nodes in shortest path between source node and v to out
+ * starting from v and ending at source (inclusive)
+ * @return: beyond-end iterator of output range */
+template<typename Distance>
+template<typename OutIter>
+OutIter BasicSearchWorkspace<Distance>::getPath(uint v, OutIter out) const {
+	//no path exists or negative cycle
+	if (getDistance(v) == inf || getDistance(v) == neginf) return out;
+	while (v != u){
+		*out = v; ++out;
+		v = prev[v];
+	}
+	*out = v; ++out;
+	return out;
+}
+
+
+} //namespace graph
+
+#endif /* SEARCHWORKSPACE_H_ */
@@ -0,0 +1,192 @@
+/*
+ * ShortestPathDag.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Christopher Mårtensson, Niklas Rosén
+ */
+
+#ifndef SHORTESTPATHDAG_H_
+#define SHORTESTPATHDAG_H_
+
+#include "GraphUtil.h"
+#include "IndexedHeap.h"
+#include "MonotoneQueue.h"
+#include <cstdint>
+
+namespace graph {
+
+
+/*** ShortestPathDag ***/
+
+/* @brief: Class for holding every shortest path from a source node, as the distances and
+ * the predecessors of each node on its shortest paths. The predecessors are stored in CSR form,
+ * those of v are getPredecessors()[getOffsets()[v] .. getOffsets()[v+1]), and can optionally be
+ * complemented by the number of shortest paths to each node. The CountMode takes effect at the
+ * next search filling in the DAG, and the buffers, the priority queue of the search included,
+ * are reused between searches
+ * @notes: ShortestPathDag holds int distances, see GraphWDP::getShortestDistanceMulti */
+template<typename Distance>
+class BasicShortestPathDag {
+public:
+	/* What is computed besides the predecessors
+	 * NO_COUNTS - nothing
+	 * SATURATING_COUNTS - the number of shortest paths to each node, UINT64_MAX if there are more
+	 * MODULAR_COUNTS - the number of shortest paths to each node modulo the modulus
+	 * DEPENDENCIES - SATURATING_COUNTS and the dependency of the source on each node, as summed
+	 * over all sources by Brandes' algorithm for betweenness centrality */
+	enum CountMode { NO_COUNTS, SATURATING_COUNTS, MODULAR_COUNTS, DEPENDENCIES };
+	static constexpr Distance inf = WeightTraits<Distance>::inf();
+private:
+	static const uint none = ~0u;
+	uint u; /* source node */
+	CountMode mode;
+	uint64_t modulus;
+	vector<Distance> dist;
+	vector<uint> offset;
+	vector<uint> pred;
+	vector<uint> order; /* settled nodes in order of distance */
+	vector<uint64_t> count;
+	vector<double> dependency;
+	/* Search state, predecessors found so far as one linked list per node */
+	vector<uint> head;
+	vector<pair<uint,uint> > link; /* (predecessor, next link) */
+	vector<bool> closed;
+	/* Priority queues of the search, one per QueueType, kept so that their memory is reused */
+	IndexedHeap<Distance> heap;
+	RadixHeap radix;
+	BucketQueue bucket;
+public:
+	BasicShortestPathDag(CountMode mode = NO_COUNTS, uint64_t modulus = 1) : u(0), mode(mode), modulus(modulus) {}
+	/* Set what the next search computes, the modulus is used by MODULAR_COUNTS and must be positive */
+	void setMode(CountMode m, uint64_t mod = 1) {mode = m; modulus = mod;}
+	CountMode getMode() const {return mode;}
+	uint getSource() const {return u;}
+	Distance getDistance(uint v) const {return dist[v];}
+	/* Range of the predecessors of v, in the order the search found them */
+	const uint* begin(uint v) const {return pred.data() + offset[v];}
+	const uint* end(uint v) const {return pred.data() + offset[v+1];}
+	const vector<uint>& getOffsets() const {return offset;}
+	const vector<uint>& getPredecessors() const {return pred;}
+	/* @return: The reached nodes in order of distance, the source first, which is a
+	 * topological order of the DAG */
+	const vector<uint>& getOrder() const {return order;}
+	/* @return: The number of shortest paths to v, 0 if it is not reached. The mode must not be NO_COUNTS */
+	uint64_t getPathCount(uint v) const {return count[v];}
+	/* @return: The sum over all targets t of the fraction of shortest paths to t that pass v,
+	 * exact as long as no path count saturates. The mode must be DEPENDENCIES */
+	double getDependency(uint v) const {return dependency[v];}
+	template<typename OutIter>
+	OutIter getPath(uint v, OutIter out) const;
+	template<typename, typename> friend class BasicGraphWDP;
+private:
+	void start(uint n, uint s);
+	void improve(uint v, Distance d, uint p);
+	void tie(uint v, uint p);
+	void settle(uint v);
+	void finish();
+	bool counting() const {return mode != NO_COUNTS;}
+	uint64_t add_count(uint64_t a, uint64_t b) const;
+};
+
+typedef BasicShortestPathDag<int> ShortestPathDag;
+
+
+template<typename Distance>
+constexpr Distance BasicShortestPathDag<Distance>::inf;
+template<typename Distance>
+const uint BasicShortestPathDag<Distance>::none;
+
+
+/* @brief: Writes the nodes of one shortest path between the source and v to out,
+ * starting from v and ending at the source (inclusive), following the first predecessors
+ * @return: beyond-end iterator of output range */
+template<typename Distance>
+template<typename OutIter>
+OutIter BasicShortestPathDag<Distance>::getPath(uint v, OutIter out) const {
+	if (dist[v] == inf) return out;
+	while (v != u){
+		*out = v; ++out;
+		v = pred[offset[v]];
+	}
+	*out = v; ++out;
+	return out;
+}
+
+/* Begins a search from s over n nodes, with s reached */
+template<typename Distance>
+void BasicShortestPathDag<Distance>::start(uint n, uint s) {
+	u = s;
+	dist.assign(n,inf);
+	offset.assign(n+1,0); // offset[v+1] counts the predecessors of v until finish
+	head.assign(n,none);
+	closed.assign(n,false);
+	link.clear();
+	order.clear();
+	if (counting()) count.assign(n,0);
+	else count.clear();
+	dependency.clear();
+	dist[s] = 0;
+}
+
+/* A shorter path to v, with last edge from p, replaces the predecessors found before */
+template<typename Distance>
+void BasicShortestPathDag<Distance>::improve(uint v, Distance d, uint p) {
+	dist[v] = d;
+	head[v] = none;
+	offset[v+1] = 0;
+	tie(v,p);
+}
+
+/* Another shortest path to v, with last edge from p */
+template<typename Distance>
+void BasicShortestPathDag<Distance>::tie(uint v, uint p) {
+	link.push_back(std::make_pair(p,head[v]));
+	head[v] = link.size()-1;
+	++offset[v+1];
+}
+
+/* The predecessors of v are final, so its path count is */
+template<typename Distance>
+void BasicShortestPathDag<Distance>::settle(uint v) {
+	closed[v] = true;
+	order.push_back(v);
+	if (!counting()) return;
+	uint64_t c = v != u ? 0 : mode == MODULAR_COUNTS ? 1 % modulus : 1;
+	for (uint i = head[v]; i != none; i = link[i].second)
+		c = add_count(c, count[link[i].first]);
+	count[v] = c;
+}
+
+/* Packs the predecessor lists into CSR form and accumulates the dependencies */
+template<typename Distance>
+void BasicShortestPathDag<Distance>::finish() {
+	uint n = dist.size();
+	for (uint v = 0; v < n; ++v)
+		offset[v+1] += offset[v];
+	pred.resize(offset[n]);
+	// the lists run from the last predecessor found to the first
+	for (uint v : order) {
+		uint j = offset[v+1];
+		for (uint i = head[v]; i != none; i = link[i].second)
+			pred[--j] = link[i].first;
+	}
+	if (mode != DEPENDENCIES) return;
+	dependency.assign(n,0);
+	for (auto it = order.rbegin(); it != order.rend(); ++it) {
+		uint v = *it;
+		double share = (1 + dependency[v]) / count[v];
+		for (const uint* p = begin(v); p != end(v); ++p)
+			dependency[*p] += count[*p] * share;
+	}
+}
+
+template<typename Distance>
+uint64_t BasicShortestPathDag<Distance>::add_count(uint64_t a, uint64_t b) const {
+	if (mode == MODULAR_COUNTS) return a >= modulus - b ? a - (modulus - b) : a + b;
+	return a > UINT64_MAX - b ? UINT64_MAX : a + b;
+}
+
+
+} //namespace graph
+
+#endif /* SHORTESTPATHDAG_H_ */
@@ -15,26 +15,36 @@ namespace graph {
 
 /*** Tree ***/
 
-/* @brief: A class containing a spanning tree */
-class Tree {
-	vector<int> prev;
-	int w;
+/* @brief: A class containing a spanning tree, or a spanning forest with one tree
+ * per connected component, whose weight is of type Distance and whose nodes are stored as Index */
+template<typename Distance, typename Index = int>
+class BasicTree {
+	vector<Index> prev; /* all ones for the roots */
+	Distance w;
 	uint N;
+	uint numTrees;
 public:
-	int getWeight() {return w;}
+	Distance getWeight() const {return w;}
+	/* @return: Number of trees, 1 for a spanning tree. 0 if getMinimumSpanningTree
+	 * found the graph to be disconnected */
+	uint getNumTrees() const {return numTrees;}
 	template<typename OutIter>
 	void getPath(OutIter out) const;
-	friend class GraphWU;
+	template<typename, typename> friend class BasicGraphWU;
 };
 
+typedef BasicTree<int> Tree;
+
 
 /* @brief: For each node i = [0,n-1), outputs a node that is connected to i in the spanning tree
- * (the root node is n-1)
+ * (the root node is n-1). In a forest the root of every tree is its largest node, and -1 is
+ * output for the roots
  * @param: out - output iterator to which to write output */
+template<typename Distance, typename Index>
 template<typename OutIter>
-void Tree::getPath(OutIter out) const {
+void BasicTree<Distance,Index>::getPath(OutIter out) const {
 	for (uint i = 0; i < N; ++i) {
-		*out = prev[i]; ++out;
+		*out = prev[i] == (Index)-1 ? -1 : (int)prev[i]; ++out;
 	}
 }
 